@@ -6,6 +6,10 @@
 #include "dab.hpp"
 #include <map>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 extern "C" {
 #include <fftw3.h>
@@ -13,34 +17,165 @@ extern "C" {
 
 namespace Csdr::Eti {
 
-    class EtiDecoder: public Csdr::Module<Csdr::complex<float>, unsigned char> {
+    class Resampler;
+    class FrameQueue;
+
+    // everything that does not depend on the type of the input samples
+    class EtiDemodulator {
         public:
-            EtiDecoder();
-            ~EtiDecoder() override;
-            bool canProcess() override;
-            void process() override;
+            // planning flags that pick FFTW_MEASURE when there is a wisdom file to keep the plans in, else FFTW_ESTIMATE
+            static constexpr unsigned int PLANNING_DEFAULT = ~0u;
+            // planningFlags are passed on to the FFTW planner, e.g. FFTW_PATIENT for even faster transforms
+            explicit EtiDemodulator(unsigned int planningFlags);
+            virtual ~EtiDemodulator();
             void setMetaWriter(MetaWriter* writer);
+            // output only the subchannels of these services, all of them without a filter. like the number of decoder
+            // threads, it is taken over before the next frame is decoded, so it may be changed while processing.
             void setServiceFilter(std::set<uint32_t> services);
+            // pass the reliability of each demapped bit on to the viterbi decoder instead of hard decisions
+            void setSoftDecision(bool soft);
+            // how far off the tuning may be, in carriers (1 kHz each) to either side. defaults to 32, at most 255.
+            void setCoarseFrequencyRange(int carriers);
+            // correct the frequency offset internally instead of sending it as metadata
+            void setFrequencyCorrection(bool enabled);
+            // FFTW wisdom file shared by all decoders in this process. It is imported before the first plans
+            // are created and updated whenever planning added new wisdom.
+            static void setWisdomFile(std::string path);
+            // sample rate of the input in S/s. anything but 2048000 is resampled internally, which works for
+            // 2400000, 2500000, 3000000, 6000000, 10000000 and other rates above 2048000 that share a big enough divisor
+            void setInputSampleRate(unsigned int rate);
+            // DAB transmission mode of the input, 1 to 4 for Mode I to IV. defaults to 1. 0 detects the mode from
+            // the input, again whenever there is no lock for a while, and sends it as metadata.
+            void setMode(int mode);
+            // decode the FIC and MSC on a thread of its own, so the next frame is demodulated in the meantime.
+            // disabling it waits for the frames already demodulated to be decoded.
+            void setPipelined(bool enabled);
+            // decode the subchannels of a frame with this many threads, the decoding thread included. defaults to 1,
+            // 0 uses one per CPU core. takes effect with the next frame that is decoded.
+            void setDecoderThreads(unsigned int threads);
+        protected:
+            // input as received by the module, and the function to convert it to float (nullptr for float input)
+            virtual const void* rawInput() = 0;
+            virtual size_t rawAvailable() = 0;
+            virtual void rawAdvance(size_t samples) = 0;
+            void (*convert_input)(const void* in, float* out, int n) = nullptr;
+            size_t input_sample_size = sizeof(Csdr::complex<float>);
+            bool frameAvailable();
+            void processFrame();
+            struct dab_state_t* dab = nullptr;
         private:
+            // decoding stage, on the caller's thread or on decoder_thread with the frames handed over through queue
+            FrameQueue* queue = nullptr;
+            std::thread decoder_thread;
+            // the frame demodulated into when there is no queue
+            struct demapped_transmission_frame_t unpipelined_frame;
+            // CIF store buffer the next frame is demodulated into
+            int next_cif = 0;
+            // lock state of the decoding stage as seen by the demodulation
+            std::atomic<bool> locked {false};
+            void decodeFrames();
+            void decodeFrame(struct demapped_transmission_frame_t* tf);
+            // settings of the decoding stage, which it takes over before the next frame so they never change under one
+            std::mutex config_mutex;
+            std::atomic<bool> config_pending {false};
+            std::set<uint32_t> pending_filter;
+            bool filter_pending = false;
+            unsigned int pending_threads = 0;
+            void applyConfig();
+            // MSC symbols the decoding stage needs for the filtered services, the demodulation skips the others
+            std::mutex msc_mutex;
+            msc_symbol_set_t msc_needed = msc_symbol_set_t().set();
+            void updateMscNeeded();
+
+            // resampled input, between resampled_start and resampled_end
+            Resampler* resampler = nullptr;
+            std::vector<Csdr::complex<float>> resampled;
+            size_t resampled_start = 0;
+            size_t resampled_end = 0;
+            void fillResampled();
+            size_t inputAvailable();
+            void advanceInput(size_t samples);
+
+            /* the frame being demodulated, starting frame_offset samples into the input. unless the input can be
+               used as it is, only the parts that are needed are converted and frequency corrected into ws.frame. */
+            Csdr::complex<float>* frame = nullptr;
+            size_t frame_offset = 0;
+            bool direct_input = true;
+            void beginFrame(size_t offset);
+            void loadFrame(size_t start, size_t length);
+
+            // full searches while acquiring, cheap corrections from the phase reference symbol while tracking
+            enum class SyncState { ACQUIRING, TRACKING };
+            SyncState sync_state = SyncState::ACQUIRING;
+            int sync_misses = 0;
             uint32_t coarse_timeshift = 0;
             int32_t fine_timeshift = 0;
+            // samples per frame the sample clock is off by, and the part of a sample not yet advanced
+            double sample_clock_drift = 0;
+            double timing_fraction = 0;
+            double reported_clock_offset = 0;
+            void followSampleClock(double timing_error);
+            void restartAcquisition();
             int32_t coarse_freq_shift = 0;
             double fine_freq_shift = 0;
             bool force_timesync = false;
-            bool sdr_demod(Csdr::complex<float>* input, struct demapped_transmission_frame_t* tf);
-            uint32_t get_coarse_time_sync(Csdr::complex<float>* input);
-            int32_t get_fine_time_sync(Csdr::complex<float>* input);
-            int32_t get_coarse_freq_shift(Csdr::complex<float>* input);
-            double get_fine_freq_corr(Csdr::complex<float>* input);
-            struct dab_state_t* dab = nullptr;
+            bool soft_decision = false;
+            int32_t coarse_freq_range = 32;
+            bool frequency_correction = false;
+            // frequency offset taken out of the input in Hz, and the oscillator phase at the start of the frame
+            double nco_offset = 0;
+            double nco_phase = 0;
+            void advanceOscillator(size_t samples);
+            bool mode_detection = false;
+            bool mode_detection_pending = false;
+            int unlocked_frames = 0;
+            int reported_mode = 0;
+            bool detectMode();
+            void selectMode(const struct dab_mode_t* mode);
+            // the front end is specialized for each transmission mode, demodulate() picks the one of the current mode
+            bool demodulate(Csdr::complex<float>* input, struct demapped_transmission_frame_t* tf);
+            template <const dab_mode_t& M> bool sdr_demod(Csdr::complex<float>* input, struct demapped_transmission_frame_t* tf);
+            template <const dab_mode_t& M> uint32_t get_coarse_time_sync(Csdr::complex<float>* input);
+            template <const dab_mode_t& M> int32_t get_fine_time_sync(fftwf_complex* prs_received_fft);
+            template <const dab_mode_t& M> int32_t get_coarse_freq_shift(fftwf_complex* prs_received_fft);
+            template <const dab_mode_t& M> double get_fine_freq_corr(Csdr::complex<float>* input);
+            template <const dab_mode_t& M> bool track_sync(Csdr::complex<float>* input, fftwf_complex* prs_received_fft);
+            // metadata comes from both stages
+            std::mutex meta_mutex;
             MetaWriter* metawriter = nullptr;
             uint16_t ensemble_id = 0;
             std::map<uint16_t, std::string> programmes;
             std::string ensemble;
 
+            // the plans depend on the transmission mode and are made again when it changes
+            unsigned int planning_flags;
             fftwf_plan forward_plan;
             fftwf_plan backward_plan;
-            fftwf_plan coarse_plan;
+            fftwf_plan coarse_forward_plan;
+            fftwf_plan coarse_backward_plan;
+            // all symbols of a transmission frame in one go, for aligned and unaligned input
+            fftwf_plan symbols_plan;
+            fftwf_plan symbols_plan_unaligned;
+            template <const dab_mode_t& M> void createPlans();
+            void destroyPlans();
+
+            // preallocated working buffers, all carved out of one 64 byte aligned block of memory. the sizes are those
+            // of Mode I, which is the largest in every dimension.
+            void* workspace = nullptr;
+            struct {
+                fftwf_complex* raw_symbols;   // [76][2048], output of symbols_plan
+                float* energy;                // null symbol search, energy of blocks of samples
+                fftwf_complex* prs_fft;       // [2048], the phase reference symbol
+                fftwf_complex* prs_star;      // [1536]
+                fftwf_complex* prs_rec_shift; // [1536]
+                fftwf_complex* convoluted;    // [1536]
+                fftwf_complex* convoluted_time; // [1536]
+                fftwf_complex* guard;         // [3][504], guard interval correlation
+                fftwf_complex* coarse;        // [2048], coarse frequency correlation
+                fftwf_complex* coarse_ref;    // [2048], spectrum of the differential phase of the prs
+                Csdr::complex<float>* frame;  // [196608], converted and frequency corrected input
+            } ws {};
+            void allocWorkspace();
 
             void sendMetaData(std::map<std::string, datatype> data);
             void processInfo(struct tf_info_t tf_info);
@@ -48,4 +183,21 @@ namespace Csdr::Eti {
             std::string decodeEbuCharset(unsigned char label[16]);
     };
 
+    // T is the type of the I and Q components of the input: float, short or unsigned char (rtl-sdr style, offset by 127.5)
+    template <typename T>
+    class EtiDecoderT: public Csdr::Module<Csdr::complex<T>, unsigned char>, public EtiDemodulator {
+        public:
+            explicit EtiDecoderT(unsigned int planningFlags = PLANNING_DEFAULT);
+            ~EtiDecoderT() override;
+            bool canProcess() override;
+            void process() override;
+        protected:
+            const void* rawInput() override;
+            size_t rawAvailable() override;
+            void rawAdvance(size_t samples) override;
+    };
+
+    // the decoder for float input, as it has always been
+    using EtiDecoder = EtiDecoderT<float>;
+
 }
\ No newline at end of file
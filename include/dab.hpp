@@ -1,11 +1,46 @@
 #pragma once
 
+#include <bitset>
 #include <cstdint>
 #include <functional>
 #include <vector>
 #include <set>
 #include <map>
 
+/* Parameters of a DAB transmission mode (ETSI EN 300 401 clause 14.2),
+   durations in samples at 2.048 MS/s */
+struct dab_mode_t {
+    int id;             /* 1 to 4 for Mode I to IV */
+    int fft_size;       /* N, one sample per 1/N of the useful symbol duration */
+    int carriers;       /* K */
+    int null_length;    /* Tnull */
+    int guard_length;   /* Tg */
+    int symbols;        /* L, including the phase reference symbol */
+    int fic_symbols;    /* symbols carrying the FIC, following the phase reference symbol */
+    int cifs;           /* CIFs per transmission frame */
+    int fibs_per_cif;
+
+    constexpr int symbol_length() const { return fft_size + guard_length; }
+    constexpr int frame_length() const { return null_length + symbols * symbol_length(); }
+    /* bits per OFDM symbol, two per carrier */
+    constexpr int symbol_bits() const { return 2 * carriers; }
+    /* carrier spacing in Hz */
+    constexpr double carrier_spacing() const { return 2048000.0 / fft_size; }
+};
+
+inline constexpr struct dab_mode_t dab_mode_1 = {1, 2048, 1536, 2656, 504, 76, 3, 4, 3};
+inline constexpr struct dab_mode_t dab_mode_2 = {2, 512, 384, 664, 126, 76, 3, 1, 3};
+inline constexpr struct dab_mode_t dab_mode_3 = {3, 256, 192, 345, 63, 153, 8, 1, 4};
+inline constexpr struct dab_mode_t dab_mode_4 = {4, 1024, 768, 1328, 252, 76, 3, 2, 3};
+
+/* Mode I has the most CIFs per transmission frame */
+#define MAX_CIFS_PER_FRAME 4
+static_assert(dab_mode_1.cifs <= MAX_CIFS_PER_FRAME && dab_mode_2.cifs <= MAX_CIFS_PER_FRAME &&
+              dab_mode_3.cifs <= MAX_CIFS_PER_FRAME && dab_mode_4.cifs <= MAX_CIFS_PER_FRAME, "too many CIFs per frame");
+
+/* The descriptor of Mode I to IV, nullptr for anything else */
+const struct dab_mode_t* dab_get_mode(int id);
+
 /* A demapped transmission frame represents a transmission frame in
    the final state before the FIC-specific and MSC-specific decoding
    stages.
@@ -18,20 +53,59 @@
 /* The FIBs for one transmission frame, and the results of CRC checking */
 struct tf_fibs_t {
     uint8_t ok_count;
+    uint8_t count;          /* 12 in Mode I, 3 to 6 in the others */
     uint8_t FIB[12][32];    /* The actual FIB data, including CRCs */
     uint8_t FIB_CRC_OK[12]; /* 1 = CRC OK, 0 = CRC Error */
 };
 
-// treshold values for the FIB CRC check to detect signal lock
-#define FIB_CRC_LOCK_VALUE_TRESHOLD 9
+// treshold values for the FIB CRC check to detect signal lock. the value is the share of good FIBs per frame in quarters.
+#define FIB_CRC_LOCK_VALUE_TRESHOLD 3
 #define FIB_CRC_LOCK_COUNT_TRESHOLD 10
 
+/* Demapped bits are stored as Viterbi decoder input symbols: 0 is a
+   "strong 0", 255 a "strong 1" and 128 an erasure. Hard decisions and
+   noiseless soft decisions are 128 -/+ SYMBOL_AMPLITUDE. */
+#define SYMBOL_AMPLITUDE 32
+#define SYMBOL_0 (128 - SYMBOL_AMPLITUDE)
+#define SYMBOL_1 (128 + SYMBOL_AMPLITUDE)
+
+/* The MSC is stored packed, as 4 bit steps of SYMBOL_AMPLITUDE / 4 around
+   the erasure, two bits per byte with the first one in the low nibble. This
+   keeps hard decisions exact and soft decisions within 128 -/+ 56, and halves
+   the memory the 16 CIFs of the time interleaving take. */
+#define PACKED_SYMBOL(n) (128 + ((n) - 8) * (SYMBOL_AMPLITUDE / 4))
+#define PACKED_0 4    /* SYMBOL_0 */
+#define PACKED_1 12   /* SYMBOL_1 */
+
+/* One bit per MSC symbol of a transmission frame, from 72 in Modes I, II and IV to 144 in Mode III */
+typedef std::bitset<144> msc_symbol_set_t;
+/* One bit per capacity unit (64 bits) of a CIF */
+typedef std::bitset<864> cif_cu_set_t;
+
+/* A CIF as it is kept for the time deinterleaving: 3072*18 bits of the MSC in
+   all modes, which are packed into 1536*18 bytes, and the FIBs that go with
+   it, 3 or 4 of them. */
+struct cif_buffer_t {
+    uint8_t msc[1536*18];
+    uint8_t fibs[4][32];
+};
+
+/* The FIC is sized for Mode I, which has the most bits in it. The other modes
+   fill the array from the start, the FIC of Mode III taking 8 symbols of 384
+   bits. The MSC is demapped straight into the CIF buffers the frame is given,
+   the CIFs following each other in the MSC symbols. */
 struct demapped_transmission_frame_t {
     uint8_t fic_symbols_demapped[3][3072];
     struct tf_fibs_t fibs;  /* The decoded and CRC-checked FIBs */
-    uint8_t msc_symbols_demapped[72][3072];
+    struct cif_buffer_t* cifs[MAX_CIFS_PER_FRAME];  /* Where the MSC goes, one buffer per CIF of the mode */
+    msc_symbol_set_t msc_demapped;  /* The MSC symbols that were demapped, the others are left as they were */
 };
 
+/* SubChId has 6 bits */
+#define MAX_SUBCHANNELS 64
+/* One bit per subchannel id */
+typedef std::bitset<MAX_SUBCHANNELS> subchannel_set_t;
+
 struct subchannel_info_t {
     int eepprot;
     int slForm;
@@ -66,6 +140,7 @@ struct tf_info_t {
     uint8_t CIFCount_hi;    /* 5 bits - 0 to 31 */
     uint8_t CIFCount_lo;    /* 8 bits - 0 to 249 */
     uint64_t timestamp;
+    int cif_count = -1;     /* CIF count of the first CIF of the frame (0 to 4999), -1 without a good FIG 0/0 */
 
     /* Information on all subchannels defined by the FIBs in this
        tranmission frame.  Note that this may not be all the active
@@ -80,29 +155,84 @@ struct tf_info_t {
 
 struct ens_info_t {
     uint16_t EId;           /* Ensemble ID */
-    uint8_t CIFCount_hi;    /* Our own CIF Count */
+    uint8_t CIFCount_hi;    /* Our own CIF Count for the next ETI frame, following the CIF ring - 0xff before the first */
     uint8_t CIFCount_lo;
     std::map<int, struct subchannel_info_t> subchans;
     std::map<uint32_t, struct service_info_t> services;
 };
 
+/* The CIF count runs from 0 to 249 in the low part and 0 to 19 in the high one */
+#define CIF_COUNT_MODULO 5000
+
+/* The CIFs received so far, oldest first, as far back as the time
+   interleaving reaches: 16 before the one to output, plus the new frame.
+   Every slot is stored twice, at s and s + CIF_RING_SIZE, so the CIFs from
+   head on are a plain array of pointers that can be handed to create_eti()
+   and the time deinterleaver as they are. */
+#define CIF_RING_SIZE 32
+struct cif_ring_t {
+    unsigned char* msc[2 * CIF_RING_SIZE];   /* 3072*18 bits each, packed */
+    unsigned char* fibs[2 * CIF_RING_SIZE];  /* The FIBs of each CIF */
+    cif_cu_set_t demapped[2 * CIF_RING_SIZE];  /* The capacity units of each CIF that were demapped */
+    int head;   /* Slot of the oldest CIF */
+    int count;  /* Number of CIFs in the ring - we need 16 before the one to output */
+    int good;   /* The newest this many CIFs came with a good FIC */
+    int seq;    /* CIF count of the oldest CIF, -1 until a FIG 0/0 was received */
+};
+
+struct viterbi_decoder;
+struct decode_pool;
+struct eti_task_t;
+
+/* Frames that may be demodulated but not yet processed at any time, the one being processed included */
+#define MAX_FRAMES_PENDING 4
+/* The 16 CIFs the ring holds after a frame was processed, and those of the pending frames */
+#define CIF_STORE_SIZE (16 + MAX_FRAMES_PENDING * MAX_CIFS_PER_FRAME)
+
 struct dab_state_t {
-    struct demapped_transmission_frame_t tfs[5]; /* We need buffers for 5 tranmission frames - the four previous, plus the new */
+    const struct dab_mode_t* mode;
     struct ens_info_t ens_info;
 
-    unsigned char* cifs_msc[16];  /* Each CIF consists of 3072*18 bits */
-    unsigned char* cifs_fibs[16];  /* Each CIF consists of 3072*18 bits */
-    int ncifs;  /* Number of CIFs in buffer - we need 16 to start outputting them */
-    int tfidx;  /* Next tf buffer to read to. */
+    /* The CIFs in the ring point into cif_store. Each frame is demodulated
+       into the mode->cifs buffers after those of the frame before, modulo
+       CIF_STORE_SIZE, so a buffer is only used again once its CIF has left
+       the ring. */
+    struct cif_ring_t cifs;
+    struct cif_buffer_t cif_store[CIF_STORE_SIZE];
     bool locked;
     bool ens_info_shown;
     int okcount;
 
     std::set<uint32_t> service_id_filter = {};
 
+    /* Viterbi decoder shared by the FIC and MSC decoding stages */
+    struct viterbi_decoder* viterbi;
+
+    /* Threads decoding the subchannels of a frame in parallel, nullptr when
+       it is all done by the calling thread. Thread t > 0 of the pool uses
+       pool_viterbi[t - 1], the calling thread the decoder above. */
+    struct decode_pool* pool;
+    std::vector<struct viterbi_decoder*> pool_viterbi;
+
+    /* The time-deinterleaved bits of the subchannel each thread decodes, thread t
+       using those from t * deinterleaved_stride on. create_eti() makes room for
+       the largest subchannel it outputs. */
+    std::vector<uint8_t> deinterleaved;
+    int deinterleaved_stride;
+
+    /* The decoding tasks of create_eti(), one per subchannel and CIF, allocated for the mode by dab_set_mode() */
+    struct eti_task_t* eti_tasks;
+
     /* Callback function to process a decoded ETI frame */
     std::function<void(uint8_t* eti)> eti_callback;
 };
 
 struct dab_state_t* init_dab_state();
-struct tf_info_t dab_process_frame(struct dab_state_t *dab);
+void destroy_dab_state(struct dab_state_t *dab);
+/* Switch to another transmission mode, which drops the lock and all buffered CIFs */
+void dab_set_mode(struct dab_state_t *dab, const struct dab_mode_t *mode);
+/* Decode the MSC with this many threads in total, 1 for none besides the calling one */
+void dab_set_threads(struct dab_state_t *dab, int threads);
+/* Decode the FIC of a demodulated frame and add its CIFs to the ring, outputting the ETI frames of those that can be
+   time-deinterleaved now */
+struct tf_info_t dab_process_frame(struct dab_state_t *dab, struct demapped_transmission_frame_t *tf);
@@ -0,0 +1,80 @@
+/* Conversion of integer input samples to float.
+ *
+ * The values are widened to 32 bit integers in registers and converted
+ * there, 16 values per step.
+ */
+
+#include "convert.hpp"
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CONVERT_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CONVERT_NEON
+#endif
+
+#define CU8_OFFSET 127.5f
+#define CU8_SCALE (1.0f / 128)
+#define CS16_SCALE (1.0f / 32768)
+
+void convert_cu8(const void* in, float* out, int n) {
+    auto src = (const uint8_t*) in;
+    int k = 0;
+#ifdef CONVERT_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 offset = _mm_set1_ps(CU8_OFFSET), scale = _mm_set1_ps(CU8_SCALE);
+    for (; k + 16 <= n; k += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (src + k));
+        __m128i lo = _mm_unpacklo_epi8(x, zero), hi = _mm_unpackhi_epi8(x, zero);
+        _mm_storeu_ps(out + k, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), offset), scale));
+        _mm_storeu_ps(out + k + 4, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), offset), scale));
+        _mm_storeu_ps(out + k + 8, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), offset), scale));
+        _mm_storeu_ps(out + k + 12, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), offset), scale));
+    }
+#endif
+#ifdef CONVERT_NEON
+    const float32x4_t offset = vdupq_n_f32(CU8_OFFSET);
+    for (; k + 16 <= n; k += 16) {
+        uint8x16_t x = vld1q_u8(src + k);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(x)), hi = vmovl_u8(vget_high_u8(x));
+        vst1q_f32(out + k, vmulq_n_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), offset), CU8_SCALE));
+        vst1q_f32(out + k + 4, vmulq_n_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), offset), CU8_SCALE));
+        vst1q_f32(out + k + 8, vmulq_n_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), offset), CU8_SCALE));
+        vst1q_f32(out + k + 12, vmulq_n_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), offset), CU8_SCALE));
+    }
+#endif
+    for (; k < n; k++) {
+        out[k] = (src[k] - CU8_OFFSET) * CU8_SCALE;
+    }
+}
+
+void convert_cs16(const void* in, float* out, int n) {
+    auto src = (const int16_t*) in;
+    int k = 0;
+#ifdef CONVERT_SSE2
+    const __m128 scale = _mm_set1_ps(CS16_SCALE);
+    for (; k + 16 <= n; k += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (src + k)), b = _mm_loadu_si128((const __m128i*) (src + k + 8));
+        /* interleaving with itself puts every value into the upper half of a 32 bit lane, the shift sign extends it */
+        _mm_storeu_ps(out + k, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16)), scale));
+        _mm_storeu_ps(out + k + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16)), scale));
+        _mm_storeu_ps(out + k + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(b, b), 16)), scale));
+        _mm_storeu_ps(out + k + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(b, b), 16)), scale));
+    }
+#endif
+#ifdef CONVERT_NEON
+    for (; k + 16 <= n; k += 16) {
+        int16x8_t a = vld1q_s16(src + k), b = vld1q_s16(src + k + 8);
+        vst1q_f32(out + k, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(a))), CS16_SCALE));
+        vst1q_f32(out + k + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(a))), CS16_SCALE));
+        vst1q_f32(out + k + 8, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(b))), CS16_SCALE));
+        vst1q_f32(out + k + 12, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(b))), CS16_SCALE));
+    }
+#endif
+    for (; k < n; k++) {
+        out[k] = src[k] * CS16_SCALE;
+    }
+}
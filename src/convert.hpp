@@ -0,0 +1,10 @@
+#pragma once
+
+/* Conversion of integer samples to float, n is the number of values (twice
+   the number of complex samples). The results are scaled to about +-1. */
+
+/* unsigned 8 bit, as delivered by rtl-sdr, centered at 127.5 */
+void convert_cu8(const void* in, float* out, int n);
+
+/* signed 16 bit */
+void convert_cs16(const void* in, float* out, int n);
@@ -5,11 +5,15 @@ david.may.muc@googlemail.com
 
 #include "csdr-eti.hpp"
 #include "ebu_chars.hpp"
-
-extern "C" {
-#include "sdr_prstab.h"
-#include "dab_tables.h"
-};
+#include "dqpsk.hpp"
+#include "energy.hpp"
+#include "nco.hpp"
+#include "resampler.hpp"
+#include "convert.hpp"
+#include "mode_tables.hpp"
+#include "mode_detect.hpp"
+#include "frame_queue.hpp"
+#include "misc.hpp"
 
 #include <iostream>
 #include <cstring>
@@ -17,147 +21,646 @@ extern "C" {
 #include <locale>
 #include <codecvt>
 #include <utility>
+#include <mutex>
+#include <cstdio>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <type_traits>
 
 using namespace Csdr::Eti;
 
-EtiDecoder::EtiDecoder() {
-    dab = init_dab_state();
-    dab->eti_callback = [this](uint8_t* eti) {
-        // writer cannot accept data. discard...
-        if (this->writer->writeable() < 6144) return;
-        std::memcpy(this->writer->getWritePointer(), eti, 6144);
-        this->writer->advance(6144);
+// Mode I has the longest transmission frames, the buffers are made for those
+#define MAX_FRAME_LENGTH 196608
+
+// samples per step when converting input for the resampler or the frame
+#define RESAMPLER_CHUNK 4096
+#define LOAD_CHUNK 2048
+
+// the frame is taken to be in sync while the energy of its first Tnull samples, the null symbol, is below this share
+// of the energy in the phase reference symbol. being a ratio, it does not depend on the input level, unlike the
+// absolute threshold it replaces, which strong input never got below. the null symbol of a clean signal is 20 dB or
+// more below the phase reference symbol. noise brings it up to the noise floor, which is half the energy of the phase
+// reference symbol at 0 dB SNR, about where decoding stops anyway. a frame that starts more than half a null symbol
+// off has more signal than that in the window, smaller timing errors are left to the fine time sync.
+#define NULL_SYMBOL_MAX_ENERGY 0.5f
+
+// the window of the OFDM symbols is kept fft_size / SYNC_GUARD_MARGIN samples into the guard interval, 8 in Mode I, as
+// a margin against intersymbol interference. the fine time sync allows for it while acquiring, tracking keeps it.
+#define SYNC_GUARD_MARGIN 256
+// tracking accepts timing corrections of up to this many samples per frame
+#define TRACK_TIMING_WINDOW 32
+// minimum coherence of the received phase reference symbol while tracking
+#define TRACK_MIN_COHERENCE 0.25f
+// consecutive frames of lost tracking or lost lock before falling back to acquisition
+#define TRACK_MAX_MISSES 3
+// share of the estimated fine frequency offset the oscillator follows per frame while tracking
+#define TRACK_FREQ_GAIN 0.5
+// share of the timing error per frame that is attributed to the sample clock
+#define TRACK_CLOCK_GAIN 0.1
+
+// frames without lock after which the transmission mode is detected again
+#define MODE_DETECT_RETRY_FRAMES 30
+
+// demodulated frames in flight between the stages when pipelined, as many as the CIF store has room for
+#define PIPELINE_SLOTS MAX_FRAMES_PENDING
+
+// the fftw planner and its wisdom are process-wide and not thread-safe, only plan execution is
+static std::mutex fftw_planner_mutex;
+static std::string wisdom_file;
+static bool wisdom_imported = false;
+
+static void exportWisdom() {
+    // write to a temporary file first so other processes never import a partial file. the name is our own, so
+    // processes writing at the same time do not mix up their files either.
+    std::string tmp = wisdom_file + "." + std::to_string(getpid()) + ".tmp";
+    if (!fftwf_export_wisdom_to_filename(tmp.c_str()) || std::rename(tmp.c_str(), wisdom_file.c_str()) != 0) {
+        std::cerr << "could not write fftw wisdom to " << wisdom_file << std::endl;
+        std::remove(tmp.c_str());
+    }
+}
+
+// place the carriers of the phase reference symbol in their fft bins, same order as in dqpsk_demap()
+template <const dab_mode_t& M>
+static void prs_spectrum(fftwf_complex* spectrum) {
+    auto prs = (const fftwf_complex*) mode_tables<M>::prs.data();
+    std::memset(spectrum, 0, sizeof(fftwf_complex) * M.fft_size);
+    for (int k = 0; k < M.carriers; k++) {
+        int bin = mode_tables<M>::bin(k);
+        spectrum[bin][0] = prs[k][0];
+        spectrum[bin][1] = prs[k][1];
+    }
+}
+
+// phase difference between neighbouring bins. a timing offset turns into a constant phase that drops out of the
+// correlation, while a frequency offset still moves the whole pattern by whole bins.
+template <const dab_mode_t& M>
+static void differentiate(const fftwf_complex* spectrum, fftwf_complex* diff) {
+    for (int b = 0; b < M.fft_size; b++) {
+        const float* cur = spectrum[b];
+        const float* next = spectrum[(b + 1) % M.fft_size];
+        diff[b][0] = next[0] * cur[0] + next[1] * cur[1];
+        diff[b][1] = next[1] * cur[0] - next[0] * cur[1];
+    }
+}
+
+void EtiDemodulator::allocWorkspace() {
+    size_t size = 0;
+    // reserve a cache line aligned chunk of the workspace and return its offset
+    auto reserve = [&size] (size_t bytes) {
+        size_t offset = size;
+        size += (bytes + 63) & ~(size_t) 63;
+        return offset;
     };
-    forward_plan = fftwf_plan_dft_1d(2048, nullptr, nullptr, FFTW_FORWARD, FFTW_ESTIMATE);
-    backward_plan = fftwf_plan_dft_1d(1536, nullptr, nullptr, FFTW_BACKWARD, FFTW_ESTIMATE);
-    coarse_plan = fftwf_plan_dft_1d(128, nullptr, nullptr, FFTW_BACKWARD, FFTW_ESTIMATE);
+    size_t raw_symbols = reserve(sizeof(fftwf_complex) * 2048 * 76);
+    size_t energy = reserve(sizeof(float) * MAX_FRAME_LENGTH / ENERGY_BLOCK);
+    size_t prs_fft = reserve(sizeof(fftwf_complex) * 2048);
+    size_t prs_star = reserve(sizeof(fftwf_complex) * 1536);
+    size_t prs_rec_shift = reserve(sizeof(fftwf_complex) * 1536);
+    size_t convoluted = reserve(sizeof(fftwf_complex) * 1536);
+    size_t convoluted_time = reserve(sizeof(fftwf_complex) * 1536);
+    size_t guard = reserve(sizeof(fftwf_complex) * 3 * 504);
+    size_t coarse = reserve(sizeof(fftwf_complex) * 2048);
+    size_t coarse_ref = reserve(sizeof(fftwf_complex) * 2048);
+    size_t frame = reserve(sizeof(Csdr::complex<float>) * MAX_FRAME_LENGTH);
+
+#ifdef MADV_HUGEPAGE
+    // the workspace spans several megabytes, so let it use transparent huge pages if the system offers them
+    const size_t alignment = 2 << 20;
+#else
+    const size_t alignment = 64;
+#endif
+    if (posix_memalign(&workspace, alignment, size) != 0) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    madvise(workspace, size, MADV_HUGEPAGE);
+#endif
+
+    auto base = (char*) workspace;
+    ws.raw_symbols = (fftwf_complex*) (base + raw_symbols);
+    ws.energy = (float*) (base + energy);
+    ws.prs_fft = (fftwf_complex*) (base + prs_fft);
+    ws.prs_star = (fftwf_complex*) (base + prs_star);
+    ws.prs_rec_shift = (fftwf_complex*) (base + prs_rec_shift);
+    ws.convoluted = (fftwf_complex*) (base + convoluted);
+    ws.convoluted_time = (fftwf_complex*) (base + convoluted_time);
+    ws.guard = (fftwf_complex*) (base + guard);
+    ws.coarse = (fftwf_complex*) (base + coarse);
+    ws.coarse_ref = (fftwf_complex*) (base + coarse_ref);
+    ws.frame = (Csdr::complex<float>*) (base + frame);
 }
 
-EtiDecoder::~EtiDecoder() {
+EtiDemodulator::EtiDemodulator(unsigned int planningFlags): planning_flags(planningFlags) {
+    dab = init_dab_state();
+    allocWorkspace();
+    createPlans<dab_mode_1>();
+}
+
+EtiDemodulator::~EtiDemodulator() {
+    setPipelined(false);
     delete metawriter;
-    delete dab;
+    delete resampler;
+    destroy_dab_state(dab);
+    destroyPlans();
+    free(workspace);
+}
+
+template <const dab_mode_t& M>
+void EtiDemodulator::createPlans() {
+    const int symbol = M.symbol_length();
+    // anything but FFTW_ESTIMATE overwrites the arrays while planning, so we need some scratch space
+    auto scratch = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * symbol * M.symbols);
+    int n[] = {M.fft_size};
+
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex);
+    // measuring is only worth its time when the result is kept for the next start
+    unsigned int planningFlags = planning_flags;
+    if (planningFlags == PLANNING_DEFAULT) planningFlags = wisdom_file.empty() ? FFTW_ESTIMATE : FFTW_MEASURE;
+    char* wisdom = nullptr;
+    if (!wisdom_file.empty()) {
+        if (!wisdom_imported) {
+            // the file may not exist yet, it is created after planning
+            fftwf_import_wisdom_from_filename(wisdom_file.c_str());
+            wisdom_imported = true;
+        }
+        wisdom = fftwf_export_wisdom_to_string();
+    }
+
+    // executed on input straight from the reader, which has no guaranteed alignment
+    forward_plan = fftwf_plan_dft_1d(M.fft_size, scratch, ws.prs_fft, FFTW_FORWARD, planningFlags | FFTW_UNALIGNED);
+    backward_plan = fftwf_plan_dft_1d(M.carriers, ws.convoluted, ws.convoluted_time, FFTW_BACKWARD, planningFlags);
+    coarse_forward_plan = fftwf_plan_dft_1d(M.fft_size, ws.coarse, ws.coarse, FFTW_FORWARD, planningFlags);
+    coarse_backward_plan = fftwf_plan_dft_1d(M.fft_size, ws.coarse, ws.coarse, FFTW_BACKWARD, planningFlags);
+    // one transform per OFDM symbol, skipping the guard interval of each
+    symbols_plan = fftwf_plan_many_dft(1, n, M.symbols, scratch, nullptr, 1, symbol, ws.raw_symbols, nullptr, 1, M.fft_size, FFTW_FORWARD, planningFlags);
+    symbols_plan_unaligned = fftwf_plan_many_dft(1, n, M.symbols, scratch, nullptr, 1, symbol, ws.raw_symbols, nullptr, 1, M.fft_size, FFTW_FORWARD, planningFlags | FFTW_UNALIGNED);
+    fftwf_free(scratch);
+
+    if (wisdom != nullptr) {
+        char* updated = fftwf_export_wisdom_to_string();
+        if (updated != nullptr && strcmp(wisdom, updated) != 0) exportWisdom();
+        free(wisdom);
+        free(updated);
+    }
+
+    // the reference for the coarse frequency search only needs to be transformed once
+    prs_spectrum<M>(ws.coarse_ref);
+    differentiate<M>(ws.coarse_ref, ws.coarse);
+    fftwf_execute(coarse_forward_plan);
+    std::memcpy(ws.coarse_ref, ws.coarse, sizeof(fftwf_complex) * M.fft_size);
+}
+
+void EtiDemodulator::destroyPlans() {
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex);
     fftwf_destroy_plan(forward_plan);
     fftwf_destroy_plan(backward_plan);
-    fftwf_destroy_plan(coarse_plan);
+    fftwf_destroy_plan(coarse_forward_plan);
+    fftwf_destroy_plan(coarse_backward_plan);
+    fftwf_destroy_plan(symbols_plan);
+    fftwf_destroy_plan(symbols_plan_unaligned);
 }
 
-void EtiDecoder::setMetaWriter(MetaWriter *writer) {
+void EtiDemodulator::setMetaWriter(MetaWriter *writer) {
+    std::lock_guard<std::mutex> lock(meta_mutex);
     auto old = metawriter;
     metawriter = writer;
     delete old;
 }
 
-void EtiDecoder::setServiceFilter(std::set<uint32_t> services) {
-    dab->service_id_filter = std::move(services);
+void EtiDemodulator::setWisdomFile(std::string path) {
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex);
+    wisdom_file = std::move(path);
+    wisdom_imported = false;
+}
+
+void EtiDemodulator::setServiceFilter(std::set<uint32_t> services) {
+    // the decoding stage reads the filter with every frame, the demodulation follows once it has taken it over
+    std::lock_guard<std::mutex> lock(config_mutex);
+    pending_filter = std::move(services);
+    filter_pending = true;
+    config_pending = true;
+}
+
+void EtiDemodulator::setSoftDecision(bool soft) {
+    soft_decision = soft;
+}
+
+void EtiDemodulator::setCoarseFrequencyRange(int carriers) {
+    // beyond that, parts of the ensemble would not be within the sampled bandwidth anymore
+    coarse_freq_range = std::min(std::max(carriers, 1), 255);
+}
+
+void EtiDemodulator::setFrequencyCorrection(bool enabled) {
+    frequency_correction = enabled;
+    nco_offset = 0;
+    nco_phase = 0;
+}
+
+void EtiDemodulator::setMode(int mode) {
+    if (mode == 0) {
+        mode_detection = true;
+        mode_detection_pending = true;
+        unlocked_frames = 0;
+        return;
+    }
+    const struct dab_mode_t* m = dab_get_mode(mode);
+    if (m == nullptr) {
+        std::cerr << "unsupported DAB transmission mode: " << mode << std::endl;
+        return;
+    }
+    mode_detection = false;
+    mode_detection_pending = false;
+    selectMode(m);
+}
+
+void EtiDemodulator::selectMode(const struct dab_mode_t* m) {
+    if (m == dab->mode) return;
+
+    // the frames still in the pipeline are decoded in the old mode
+    if (queue != nullptr) queue->drain();
+    destroyPlans();
+    switch (m->id) {
+        case 1: createPlans<dab_mode_1>(); break;
+        case 2: createPlans<dab_mode_2>(); break;
+        case 3: createPlans<dab_mode_3>(); break;
+        case 4: createPlans<dab_mode_4>(); break;
+    }
+    dab_set_mode(dab, m);
+    locked = false;
+    msc_needed.set();
+
+    // nothing learned about the timing applies to the new mode
+    sync_state = SyncState::ACQUIRING;
+    sync_misses = 0;
+    coarse_timeshift = 0;
+    fine_timeshift = 0;
+    sample_clock_drift = 0;
+    timing_fraction = 0;
+    coarse_freq_shift = 0;
+    fine_freq_shift = 0;
+    force_timesync = false;
+}
+
+void EtiDemodulator::setPipelined(bool enabled) {
+    if (enabled == (queue != nullptr)) return;
+    if (enabled) {
+        queue = new FrameQueue(PIPELINE_SLOTS);
+        decoder_thread = std::thread([this] { decodeFrames(); });
+    } else {
+        queue->close();
+        decoder_thread.join();
+        delete queue;
+        queue = nullptr;
+    }
+}
+
+void EtiDemodulator::setDecoderThreads(unsigned int threads) {
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::lock_guard<std::mutex> lock(config_mutex);
+    pending_threads = threads;
+    config_pending = true;
+}
+
+void EtiDemodulator::applyConfig() {
+    std::unique_lock<std::mutex> lock(config_mutex);
+    config_pending = false;
+    if (filter_pending) {
+        dab->service_id_filter = std::move(pending_filter);
+        pending_filter.clear();
+        filter_pending = false;
+    }
+    unsigned int threads = pending_threads;
+    pending_threads = 0;
+    // starting threads takes a while, and the settings may change again in the meantime
+    lock.unlock();
+    if (threads > 0) dab_set_threads(dab, (int) threads);
+}
+
+void EtiDemodulator::decodeFrames() {
+    while (auto tf = queue->front()) {
+        decodeFrame(tf);
+        queue->pop();
+    }
+}
+
+void EtiDemodulator::decodeFrame(struct demapped_transmission_frame_t* tf) {
+    if (config_pending.load(std::memory_order_acquire)) applyConfig();
+    auto info = dab_process_frame(dab, tf);
+    locked = dab->locked;
+    updateMscNeeded();
+    processInfo(info);
 }
 
-void EtiDecoder::sendMetaData(std::map<std::string, datatype> data) {
+void EtiDemodulator::updateMscNeeded() {
+    auto needed = needed_msc_symbols(dab);
+    std::lock_guard<std::mutex> lock(msc_mutex);
+    msc_needed = needed;
+}
+
+void EtiDemodulator::sendMetaData(std::map<std::string, datatype> data) {
+    std::lock_guard<std::mutex> lock(meta_mutex);
     if (metawriter == nullptr) return;
     metawriter->sendMetaData(std::move(data));
 }
 
-bool EtiDecoder::canProcess() {
-    return this->reader->available() >= 196608 * 2;
+void EtiDemodulator::setInputSampleRate(unsigned int rate) {
+    Resampler* old = resampler;
+    resampler = rate == 2048000 ? nullptr : new Resampler(rate);
+    delete old;
+    // room for four frames, so the remainder only has to be moved to the front about every other frame
+    resampled.resize(resampler == nullptr ? 0 : MAX_FRAME_LENGTH * 4);
+    resampled_start = resampled_end = 0;
 }
 
-void EtiDecoder::process() {
-    Csdr::complex<float>* input = this->reader->getReadPointer();
-
-    if (sdr_demod(input, &dab->tfs[dab->tfidx])) {
-        auto info = dab_process_frame(dab);
-        processInfo(info);
+void EtiDemodulator::fillResampled() {
+    if (resampled.size() - resampled_end < MAX_FRAME_LENGTH) {
+        std::memmove(resampled.data(), resampled.data() + resampled_start, sizeof(Csdr::complex<float>) * (resampled_end - resampled_start));
+        resampled_end -= resampled_start;
+        resampled_start = 0;
+    }
+    size_t consumed;
+    if (convert_input == nullptr) {
+        resampled_end += resampler->process((const Csdr::complex<float>*) rawInput(), rawAvailable(), resampled.data() + resampled_end, resampled.size() - resampled_end, consumed);
+        rawAdvance(consumed);
+        return;
+    }
+    // integer input is converted in chunks that stay in the cache until the resampler has read them
+    Csdr::complex<float> converted[RESAMPLER_CHUNK];
+    while (resampled_end < resampled.size()) {
+        size_t length = std::min(rawAvailable(), (size_t) RESAMPLER_CHUNK);
+        if (length <= resampler->history()) break;
+        convert_input(rawInput(), (float*) converted, (int) length * 2);
+        resampled_end += resampler->process(converted, length, resampled.data() + resampled_end, resampled.size() - resampled_end, consumed);
+        if (consumed == 0) break;
+        rawAdvance(consumed);
     }
+}
 
-    this->reader->advance(196608 + coarse_timeshift + fine_timeshift);
+size_t EtiDemodulator::inputAvailable() {
+    if (resampler == nullptr) return rawAvailable();
+    return resampled_end - resampled_start;
 }
 
-bool EtiDecoder::sdr_demod(Csdr::complex<float>* input, struct demapped_transmission_frame_t* tf) {
-    coarse_timeshift = get_coarse_time_sync(input);
-    force_timesync = false;
-    if (coarse_timeshift) {
-        std::cerr << "coarse time shift: " << coarse_timeshift << std::endl;
-        return false;
+void EtiDemodulator::advanceInput(size_t samples) {
+    if (resampler == nullptr) {
+        rawAdvance(samples);
+    } else {
+        resampled_start += samples;
     }
+}
 
-    if (coarse_freq_shift) {
-        fine_timeshift = 0;
+void EtiDemodulator::beginFrame(size_t offset) {
+    frame_offset = offset;
+    direct_input = (resampler != nullptr || convert_input == nullptr) && !frequency_correction;
+    if (!direct_input) {
+        frame = ws.frame;
+    } else if (resampler != nullptr) {
+        frame = resampled.data() + resampled_start + offset;
     } else {
-        fine_timeshift = get_fine_time_sync(input);
+        frame = (Csdr::complex<float>*) rawInput() + offset;
     }
+}
 
-    coarse_freq_shift = get_coarse_freq_shift(input);
-    if (abs(coarse_freq_shift) > 1) {
-        sendMetaData({ {"coarse_frequency_shift", (int64_t) coarse_freq_shift} });
-        //std::cerr << "coarse frequency shift: " << coarse_freq_shift << std::endl;
-        force_timesync = true;
-        return false;
+void EtiDemodulator::loadFrame(size_t start, size_t length) {
+    if (direct_input) return;
+    const char* source;
+    void (*convert)(const void* in, float* out, int n);
+    size_t sample_size;
+    if (resampler != nullptr) {
+        source = (const char*) (resampled.data() + resampled_start);
+        convert = nullptr;
+        sample_size = sizeof(Csdr::complex<float>);
+    } else {
+        source = (const char*) rawInput();
+        convert = convert_input;
+        sample_size = input_sample_size;
     }
+    source += (frame_offset + start) * sample_size;
+    auto out = (float*) (frame + start);
+    double increment = -2 * M_PI * nco_offset / 2048000;
+    double phase = nco_phase + increment * start;
 
-    fine_freq_shift = get_fine_freq_corr(input);
-    if (fine_freq_shift != 0) {
-        sendMetaData({ {"fine_frequency_shift", fine_freq_shift} });
-        //std::cerr << "fine frequency shift: " << fine_freq_shift << std::endl;
+    // in chunks, so the converted samples are still in the cache for the frequency correction
+    for (size_t k = 0; k < length; k += LOAD_CHUNK) {
+        int n = (int) std::min(length - k, (size_t) LOAD_CHUNK);
+        const void* in = source + k * sample_size;
+        if (convert != nullptr) {
+            convert(in, out + 2 * k, 2 * n);
+            in = out + 2 * k;
+        }
+        if (frequency_correction) {
+            phase = nco_rotate((const float*) in, out + 2 * k, n, phase, increment);
+        }
+    }
+}
+
+bool EtiDemodulator::frameAvailable() {
+    if (resampler != nullptr) fillResampled();
+    size_t needed = (size_t) dab->mode->frame_length() * 2;
+    if (mode_detection_pending) needed = std::max(needed, (size_t) MODE_DETECT_SAMPLES);
+    return inputAvailable() >= needed;
+}
+
+bool EtiDemodulator::detectMode() {
+    beginFrame(0);
+    loadFrame(0, MODE_DETECT_SAMPLES);
+    const struct dab_mode_t* mode = dab_detect_mode((const float*) frame, ws.energy);
+    if (mode == nullptr) return false;
+
+    mode_detection_pending = false;
+    selectMode(mode);
+    if (mode->id != reported_mode) {
+        reported_mode = mode->id;
+        sendMetaData({ {"transmission_mode", (int64_t) mode->id} });
     }
+    return true;
+}
 
+void EtiDemodulator::processFrame() {
+    if (mode_detection_pending && !detectMode()) {
+        // no DAB signal in there, so there is no point in trying to demodulate it
+        advanceOscillator(MODE_DETECT_SAMPLES);
+        advanceInput(MODE_DETECT_SAMPLES);
+        return;
+    }
 
-    /* raw symbols */
-    fftwf_complex symbols[76][2048] = {0, 0};
+    struct demapped_transmission_frame_t* tf = queue != nullptr ? queue->acquire() : &unpipelined_frame;
+    // the MSC goes straight into the CIF store, the buffers after those of the frame before
+    for (int c = 0; c < dab->mode->cifs; c++) {
+        tf->cifs[c] = &dab->cif_store[(next_cif + c) % CIF_STORE_SIZE];
+    }
 
-    /* d-qpsk */
-    for (int i = 0; i < 76; i++) {
-        fftwf_execute_dft(forward_plan, (fftwf_complex*) &input[2656 + (2552 * i) + 504], symbols[i]);
-        fftwf_complex tmp;
-        for (int j = 0; j < 2048/2; j++)
-        {
-            tmp[0]     = symbols[i][j][0];
-            tmp[1]     = symbols[i][j][1];
-            symbols[i][j][0]    = symbols[i][j+2048/2][0];
-            symbols[i][j][1]    = symbols[i][j+2048/2][1];
-            symbols[i][j+2048/2][0] = tmp[0];
-            symbols[i][j+2048/2][1] = tmp[1];
+    beginFrame(0);
+    bool demodulated = demodulate(frame, tf);
+    size_t skipped = 0;
+    if (!demodulated && coarse_timeshift) {
+        // two frames are always available, so a complete frame is still there from the new null symbol on
+        skipped = coarse_timeshift;
+        advanceOscillator(skipped);
+        beginFrame(skipped);
+        demodulated = demodulate(frame, tf);
+    }
+
+    if (demodulated) {
+        next_cif = (next_cif + dab->mode->cifs) % CIF_STORE_SIZE;
+        if (queue != nullptr) {
+            queue->push();
+        } else {
+            decodeFrame(tf);
         }
+    }
+
+    if (mode_detection) {
+        if (locked) {
+            unlocked_frames = 0;
+        } else if (++unlocked_frames >= MODE_DETECT_RETRY_FRAMES) {
+            mode_detection_pending = true;
+            unlocked_frames = 0;
+        }
+    }
+
+    // if the null symbol still is somewhere else, start over from there
+    size_t advance = coarse_timeshift ? coarse_timeshift : dab->mode->frame_length() + fine_timeshift;
+    advance = std::min(advance, inputAvailable() - skipped);
+    advanceOscillator(advance);
+    advanceInput(skipped + advance);
+}
+
+void EtiDemodulator::advanceOscillator(size_t samples) {
+    // keep the oscillator phase continuous across frames
+    nco_phase = remainder(nco_phase - 2 * M_PI * nco_offset * samples / 2048000, 2 * M_PI);
+}
+
+bool EtiDemodulator::demodulate(Csdr::complex<float>* input, struct demapped_transmission_frame_t* tf) {
+    switch (dab->mode->id) {
+        case 2: return sdr_demod<dab_mode_2>(input, tf);
+        case 3: return sdr_demod<dab_mode_3>(input, tf);
+        case 4: return sdr_demod<dab_mode_4>(input, tf);
+        default: return sdr_demod<dab_mode_1>(input, tf);
+    }
+}
 
+template <const dab_mode_t& M>
+bool EtiDemodulator::sdr_demod(Csdr::complex<float>* input, struct demapped_transmission_frame_t* tf) {
+    // the phase reference symbol starts after the null symbol, its useful part after the guard interval
+    constexpr int prs_start = M.null_length;
+    constexpr int prs_useful = M.null_length + M.guard_length;
+    constexpr int symbol = M.symbol_length();
+
+    coarse_timeshift = get_coarse_time_sync<M>(input);
+    force_timesync = false;
+    if (coarse_timeshift) {
+        std::cerr << "coarse time shift: " << coarse_timeshift << std::endl;
+        restartAcquisition();
+        return false;
     }
 
-    /* symbols d-qpsk-ed */
-    fftwf_complex* symbols_d = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * 2048 * 76);
+    // the phase reference symbol, including its guard interval
+    loadFrame(prs_start, symbol);
+
+    if (sync_state == SyncState::ACQUIRING) {
+        /* the phase reference symbol in frequency domain, used by both fine time sync and coarse frequency search */
+        fftwf_execute_dft(forward_plan, (fftwf_complex*) &input[prs_useful], ws.prs_fft);
+
+        if (coarse_freq_shift) {
+            fine_timeshift = 0;
+        } else {
+            fine_timeshift = get_fine_time_sync<M>(ws.prs_fft);
+        }
+
+        coarse_freq_shift = get_coarse_freq_shift<M>(ws.prs_fft);
+        if (coarse_freq_shift != 0 && frequency_correction) {
+            // whole carriers can be taken out right away, so this frame does not need to be dropped
+            nco_offset += coarse_freq_shift * M.carrier_spacing();
+            loadFrame(prs_start, symbol);
+            fftwf_execute_dft(forward_plan, (fftwf_complex*) &input[prs_useful], ws.prs_fft);
+            fine_timeshift = get_fine_time_sync<M>(ws.prs_fft);
+            coarse_freq_shift = 0;
+        }
+        if (abs(coarse_freq_shift) > 1) {
+            sendMetaData({ {"coarse_frequency_shift", (int64_t) coarse_freq_shift} });
+            //std::cerr << "coarse frequency shift: " << coarse_freq_shift << std::endl;
+            force_timesync = true;
+            return false;
+        }
+
+        fine_freq_shift = get_fine_freq_corr<M>(input);
 
-    for (int j = 1; j < 76; j++) {
-        for (int i = 256; i < 1793; i++) {
-            symbols_d[j * 2048 + i][0] =
-                    ((symbols[j][i][0] * symbols[j-1][i][0])
-                    +(symbols[j][i][1] * symbols[j-1][i][1]))
-                    /(symbols[j - 1][i][0] * symbols[j - 1][i][0] + symbols[j - 1][i][1] * symbols[j - 1][i][1]);
-            symbols_d[j * 2048 + i][1] =
-                    ((symbols[j][i][0] * symbols[j-1][i][1])
-                    -(symbols[j][i][1] * symbols[j-1][i][0]))
-                    /(symbols[j - 1][i][0] * symbols[j - 1][i][0] + symbols[j - 1][i][1] * symbols[j-1][i][1]);
+        if (locked && coarse_freq_shift == 0) {
+            sync_state = SyncState::TRACKING;
+            sync_misses = 0;
         }
     }
 
-    uint8_t* dst = tf->fic_symbols_demapped[0];
+    /* with a service filter, only the MSC symbols of its subchannels are demapped. they also need the symbols before
+       them for the differential demodulation, everything else is not even transformed. */
+    constexpr int msc_start = 1 + M.fic_symbols;
+    msc_symbol_set_t needed_msc;
+    {
+        std::lock_guard<std::mutex> lock(msc_mutex);
+        needed_msc = msc_needed;
+    }
+    bool demap[M.symbols], transform[M.symbols];
+    bool all = true;
+    for (int j = 0; j < M.symbols; j++) {
+        demap[j] = j < msc_start || needed_msc[j - msc_start];
+        all = all && demap[j];
+    }
+    for (int j = 0; j < M.symbols; j++) {
+        transform[j] = demap[j] || (j + 1 < M.symbols && demap[j + 1]);
+    }
 
-    int k, kk;
-    for (int j=1; j<76; j++) {
-        if (j == 4) { dst = tf->msc_symbols_demapped[0]; }
-        k = 0;
-        for (int i = 256; i < 1793; i++){
-            if (i != 1024) {
-                /* Frequency deinterleaving and QPSK demapping combined */
-                kk = rev_freq_deint_tab[k++];
-                dst[kk] = (symbols_d[j * 2048 + i][0] > 0) ? 0 : 1;
-                dst[1536 + kk] = (symbols_d[j * 2048 + i][1] > 0) ? 1 : 0;
-            }
+    auto in = (fftwf_complex*) &input[prs_useful];
+    auto symbols = (fftwf_complex (*)[M.fft_size]) ws.raw_symbols;
+    if (all) {
+        /* raw symbols, the symbol distance keeps the alignment the same for all of them */
+        for (int j = 1; j < M.symbols; j++) {
+            // the guard intervals are not needed anymore
+            loadFrame(prs_useful + j * symbol, M.fft_size);
+        }
+        fftwf_execute_dft(fftwf_alignment_of((float*) in) == 0 ? symbols_plan : symbols_plan_unaligned, in, ws.raw_symbols);
+    } else {
+        for (int j = 0; j < M.symbols; j++) {
+            if (!transform[j]) continue;
+            if (j > 0) loadFrame(prs_useful + j * symbol, M.fft_size);
+            fftwf_execute_dft(forward_plan, in + j * symbol, symbols[j]);
         }
-        dst += 3072;
     }
 
-    fftwf_free(symbols_d);
+    if (sync_state == SyncState::TRACKING) {
+        // the first symbol is the phase reference symbol, so tracking does not need a transform of its own
+        if (track_sync<M>(input, symbols[0]) && locked) {
+            sync_misses = 0;
+        } else if (++sync_misses >= TRACK_MAX_MISSES) {
+            std::cerr << "tracking lost, resynchronizing" << std::endl;
+            restartAcquisition();
+            force_timesync = true;
+        }
+    }
+
+    if (frequency_correction) {
+        // the estimate is what is left after the correction, so it adds to the oscillator frequency
+        nco_offset += (sync_state == SyncState::TRACKING ? TRACK_FREQ_GAIN : 1.0) * fine_freq_shift;
+    } else if (fine_freq_shift != 0) {
+        sendMetaData({ {"fine_frequency_shift", fine_freq_shift} });
+        //std::cerr << "fine frequency shift: " << fine_freq_shift << std::endl;
+    }
+
+    /* d-qpsk, frequency deinterleaving and demapping */
+    tf->msc_demapped = needed_msc;
+    for (int j = 1; j < msc_start; j++) {
+        dqpsk_demap<M>(symbols[j], symbols[j - 1], tf->fic_symbols_demapped[0] + (j - 1) * M.symbol_bits(), soft_decision);
+    }
+    // the MSC is stored packed, two bits per byte, and each CIF takes the same number of symbols
+    constexpr int cif_symbols = 3072 * 18 / M.symbol_bits();
+    for (int j = msc_start; j < M.symbols; j++) {
+        const int s = j - msc_start;
+        if (demap[j]) dqpsk_demap_packed<M>(symbols[j], symbols[j - 1], tf->cifs[s / cif_symbols]->msc + (s % cif_symbols) * M.symbol_bits() / 2, soft_decision);
+    }
 
     return true;
 }
 
-void EtiDecoder::processInfo(struct tf_info_t tf_info) {
+void EtiDemodulator::processInfo(struct tf_info_t tf_info) {
     // not locked on yet
     if (tf_info.EId == 0) return;
 
@@ -181,8 +684,9 @@ void EtiDecoder::processInfo(struct tf_info_t tf_info) {
             programmes[l.service_id] = label;
         }
     }
-    if (touched && metawriter != nullptr) {
-        metawriter->sendProgrammes(programmes);
+    if (touched) {
+        std::lock_guard<std::mutex> lock(meta_mutex);
+        if (metawriter != nullptr) metawriter->sendProgrammes(programmes);
     }
 
     if (tf_info.ensembleLabel.ensemble_id != 0) {
@@ -198,7 +702,7 @@ void EtiDecoder::processInfo(struct tf_info_t tf_info) {
     }
 }
 
-std::string EtiDecoder::decodeLabel(unsigned char label[16], uint8_t charset) {
+std::string EtiDemodulator::decodeLabel(unsigned char label[16], uint8_t charset) {
     std::string result;
     if (charset == 0) {
         result = decodeEbuCharset(label);
@@ -218,7 +722,7 @@ std::string EtiDecoder::decodeLabel(unsigned char label[16], uint8_t charset) {
     return result;
 }
 
-std::string EtiDecoder::decodeEbuCharset(unsigned char label[16]) {
+std::string EtiDemodulator::decodeEbuCharset(unsigned char label[16]) {
     wchar_t translated[16];
     for (int i = 0; i < 16; i++) {
         translated[i] = ebu_charset[label[i]];
@@ -230,96 +734,117 @@ std::string EtiDecoder::decodeEbuCharset(unsigned char label[16]) {
     return converter.to_bytes(std::wstring(translated, 16));
 }
 
-uint32_t EtiDecoder::get_coarse_time_sync(Csdr::complex<float>* input) {
-    int32_t tnull = 2656; // was 2662? why?
-    int32_t j, k;
-    float filt[196608 - tnull];
-
-    // check for energy in fist tnull samples
-    float e = 0;
-    float threshold = 40;
-    for (k = 0; k < tnull; k += 10)
-        e += fabsf(input[k].i());
+template <const dab_mode_t& M>
+uint32_t EtiDemodulator::get_coarse_time_sync(Csdr::complex<float>* input) {
+    const int32_t tnull = M.null_length; // was 2662? why?
+    const int32_t windows = M.frame_length() - tnull;
+    const int32_t blocks = M.frame_length() / ENERGY_BLOCK;
+    const int32_t null_blocks = tnull / ENERGY_BLOCK;
+    auto iq = (const float*) input;
+    int32_t j;
 
-    if (e < threshold && !force_timesync)
+    loadFrame(0, 2 * tnull);
+    // check for energy in the first tnull samples, compared to the phase reference symbol following them
+    float e = window_energy(iq, tnull);
+    float e_prs = window_energy(iq + 2 * tnull, tnull);
+    if (e < NULL_SYMBOL_MAX_ENERGY * e_prs && !force_timesync)
         return 0;
 
     //fprintf(stderr,"Resync\n");
     // energy was to high so we assume we are not in sync
-    // subsampled filter to detect where the null symbol is
-    memset(filt, 0, sizeof(float) * (196608 - tnull) / 10);
-    for (j = 0; j < (196608 - tnull) / 10; j++)
-        for (k = 0; k < tnull; k += 10)
-            filt[j] += fabsf(input[j * 10 + k].i());
-
-    // finding the minimum in filtered data gives position of null symbol
-    float minVal = 9999999;
-    uint32_t minPos = 0;
-    for (j = 0; j < (196608 - tnull) / 10;j++){
-        if (filt[j] < minVal) {
-            minVal = filt[j];
-            minPos = j * 10;
+    loadFrame(2 * tnull, M.frame_length() - 2 * tnull);
+    // running sum over the block energies gives the energy of windows starting at every block
+    float* energy = ws.energy;
+    block_energy(iq, energy, blocks);
+
+    double sum = 0;
+    for (j = 0; j < null_blocks; j++)
+        sum += energy[j];
+
+    // finding the minimum gives the position of the null symbol, to within one block
+    double minVal = sum;
+    int32_t minBlock = 0;
+    for (j = 1; j <= windows / ENERGY_BLOCK; j++) {
+        sum += energy[j + null_blocks - 1] - energy[j - 1];
+        if (sum < minVal) {
+            minVal = sum;
+            minBlock = j;
+        }
+    }
+
+    // refine to the exact sample, again with a running sum
+    int32_t start = std::max(minBlock * ENERGY_BLOCK - (ENERGY_BLOCK - 1), 0);
+    int32_t end = std::min(minBlock * ENERGY_BLOCK + (ENERGY_BLOCK - 1), windows - 1);
+    sum = window_energy(iq + 2 * start, tnull);
+    minVal = sum;
+    uint32_t minPos = start;
+    for (j = start + 1; j <= end; j++) {
+        const float* out = iq + 2 * (j - 1);
+        const float* in = iq + 2 * (j + tnull - 1);
+        sum += (in[0] * in[0] + in[1] * in[1]) - (out[0] * out[0] + out[1] * out[1]);
+        if (sum < minVal) {
+            minVal = sum;
+            minPos = j;
         }
     }
     //fprintf(stderr,"calculated position of nullsymbol: %f",minPos*2);
     return minPos;
 }
 
-int32_t EtiDecoder::get_fine_time_sync(Csdr::complex<float> *input) {
+template <const dab_mode_t& M>
+int32_t EtiDemodulator::get_fine_time_sync(fftwf_complex *prs_received_fft) {
+    constexpr int K = M.carriers;
+    auto prs = (const fftwf_complex*) mode_tables<M>::prs.data();
     /* correlation in frequency domain
        e.g. J.Cho "PC-based receiver for Eureka-147" 2001
        e.g. K.Taura "A DAB receiver" 1996
     */
 
-    /* first we have to transfer the receive prs symbol in frequency domain */
-    fftwf_complex prs_received_fft[2048];
-    fftwf_execute_dft(forward_plan, (fftwf_complex*) &input[2656 + 504], &prs_received_fft[0]);
-
     /* now we build the complex conjugate of the known prs */
-    // 1536 as only the carries are used
-    fftwf_complex prs_star[1536];
+    // K as only the carries are used
+    fftwf_complex* prs_star = ws.prs_star;
     int i;
-    for (i = 0; i < 1536; i++) {
-        prs_star[i][0] = prs_static[i][0];
-        prs_star[i][1] = -1 * prs_static[i][1];
+    for (i = 0; i < K; i++) {
+        prs_star[i][0] = prs[i][0];
+        prs_star[i][1] = -1 * prs[i][1];
     }
 
     /* fftshift the received prs
        at this point we have to be coarse frequency sync
        however we can simply shift the bins */
-    fftwf_complex prs_rec_shift[1536];
+    fftwf_complex* prs_rec_shift = ws.prs_rec_shift;
     // TODO allow for coarse frequency shift !=0
     // int32_t cf_shift = 0;
     // matlab notation (!!!-1)
     // 769:1536+s
     //  2:769+s why 2? I dont remember, but peak is very strong
-    for (i = 0; i < 1536; i++) {
-        if (i < 768) {
-            prs_rec_shift[i][0] = prs_received_fft[i + 1280][0];
-            prs_rec_shift[i][1] = prs_received_fft[i + 1280][1];
+    for (i = 0; i < K; i++) {
+        if (i < K / 2) {
+            prs_rec_shift[i][0] = prs_received_fft[i + M.fft_size - K / 2][0];
+            prs_rec_shift[i][1] = prs_received_fft[i + M.fft_size - K / 2][1];
         }
-        if (i >= 768) {
-            prs_rec_shift[i][0] = prs_received_fft[i - 765][0];
-            prs_rec_shift[i][1] = prs_received_fft[i - 765][1];
+        if (i >= K / 2) {
+            prs_rec_shift[i][0] = prs_received_fft[i - K / 2 + 3][0];
+            prs_rec_shift[i][1] = prs_received_fft[i - K / 2 + 3][1];
         }
     }
 
     /* now we convolute both symbols */
-    fftwf_complex convoluted_prs[1536];
+    fftwf_complex* convoluted_prs = ws.convoluted;
     int s;
-    for (s=0;s<1536;s++) {
+    for (s=0;s<K;s++) {
         convoluted_prs[s][0] = prs_rec_shift[s][0] * prs_star[s][0] - prs_rec_shift[s][1] * prs_star[s][1];
         convoluted_prs[s][1] = prs_rec_shift[s][0] * prs_star[s][1] + prs_rec_shift[s][1] * prs_star[s][0];
     }
 
     /* and finally we transfer the convolution back into time domain */
-    fftwf_complex convoluted_prs_time[1536];
-    fftwf_execute_dft(backward_plan, &convoluted_prs[0], &convoluted_prs_time[0]);
+    fftwf_complex* convoluted_prs_time = ws.convoluted_time;
+    fftwf_execute(backward_plan);
 
     int32_t maxPos=0;
     float tempVal;
     float maxVal =- 99999;
-    for (i=0;i<1536;i++) {
+    for (i=0;i<K;i++) {
         tempVal = sqrtf((convoluted_prs_time[i][0] * convoluted_prs_time[i][0]) + (convoluted_prs_time[i][1] * convoluted_prs_time[i][1]));
         if (tempVal > maxVal) {
             maxPos = i;
@@ -327,106 +852,213 @@ int32_t EtiDecoder::get_fine_time_sync(Csdr::complex<float> *input) {
         }
     }
 
-    if (maxPos < 1536 / 2) {
-        return maxPos + 8;
+    if (maxPos < K / 2) {
+        return maxPos + M.fft_size / SYNC_GUARD_MARGIN;
     } else {
-        return maxPos - 1536;
+        return maxPos - K;
     }
 }
 
-int32_t EtiDecoder::get_coarse_freq_shift(Csdr::complex<float> *input) {
-    fftwf_complex symbols[2048] = {0};
-    fftwf_execute_dft(forward_plan, (fftwf_complex*) &input[2656 + 505 + fine_timeshift], symbols);
+template <const dab_mode_t& M>
+int32_t EtiDemodulator::get_coarse_freq_shift(fftwf_complex *prs_received_fft) {
+    constexpr int N = M.fft_size;
+    /* cross-correlation of the differential phase of the received prs with the known one, for all shifts at once:
+       xcorr = ifft(fft(received) * conj(fft(reference))) */
+    fftwf_complex* corr = ws.coarse;
+    const fftwf_complex* ref = ws.coarse_ref;
+    differentiate<M>(prs_received_fft, corr);
+    fftwf_execute(coarse_forward_plan);
 
-    fftwf_complex tmp;
-    for (int i = 0; i < 2048/2; i++)
-    {
-        tmp[0]     = symbols[i][0];
-        tmp[1]     = symbols[i][1];
-        symbols[i][0]    = symbols[i + 2048 / 2][0];
-        symbols[i][1]    = symbols[i + 2048 / 2][1];
-        symbols[i + 2048 / 2][0] = tmp[0];
-        symbols[i + 2048 / 2][1] = tmp[1];
+    for (int b = 0; b < N; b++) {
+        float re = corr[b][0] * ref[b][0] + corr[b][1] * ref[b][1];
+        float im = corr[b][1] * ref[b][0] - corr[b][0] * ref[b][1];
+        corr[b][0] = re;
+        corr[b][1] = im;
     }
+    fftwf_execute(coarse_backward_plan);
 
-    int len = 128;
-    fftwf_complex convoluted_prs[len];
-    int s;
-    int freq_hub = 14; // + and - center freq
-    int k;
-    float global_max = -99999;
-    int global_max_pos = 0;
-    for (k = -freq_hub; k <= freq_hub; k++) {
-
-        for (s = 0; s < len; s++) {
-            convoluted_prs[s][0] = prs_static[freq_hub+s][0] * symbols[freq_hub+k+256+s][0]-
-                    (-1)*prs_static[freq_hub+s][1] * symbols[freq_hub+k+256+s][1];
-            convoluted_prs[s][1] = prs_static[freq_hub+s][0] * symbols[freq_hub+k+256+s][1]+
-                    (-1)*prs_static[freq_hub+s][1] * symbols[freq_hub+k+256+s][0];
-        }
-        fftwf_complex convoluted_prs_time[len];
-        fftwf_execute_dft(coarse_plan, &convoluted_prs[0], &convoluted_prs_time[0]);
-
-        float tempVal;
-        float maxVal=-99999;
-        for (s=0;s<len;s++) {
-            tempVal = sqrtf((convoluted_prs_time[s][0] * convoluted_prs_time[s][0]) + (convoluted_prs_time[s][1] * convoluted_prs_time[s][1]));
-            if (tempVal>maxVal) {
-                maxVal = tempVal;
-            }
-        }
-        //fprintf(stderr,"%f ",maxVal);
-
-
-        if (maxVal>global_max) {
-            global_max = maxVal;
-            global_max_pos = k;
+    // bin k of the result is the correlation with the received spectrum moved up by k carriers. the smaller modes
+    // have fewer unused bins to either side of the ensemble.
+    const int32_t range = std::min(coarse_freq_range, (N - M.carriers) / 2 - 1);
+    float maxVal = -1;
+    int32_t maxPos = 0;
+    for (int32_t k = -range; k <= range; k++) {
+        const float* c = corr[(k + N) % N];
+        float tempVal = c[0] * c[0] + c[1] * c[1];
+        if (tempVal > maxVal) {
+            maxVal = tempVal;
+            maxPos = k;
         }
     }
-    //fprintf(stderr,"MAXPOS %d\n",global_max_pos);
-    return global_max_pos;
+    //fprintf(stderr,"MAXPOS %d\n",maxPos);
+    return maxPos;
 }
 
-double EtiDecoder::get_fine_freq_corr(Csdr::complex<float> *input) {
+template <const dab_mode_t& M>
+double EtiDemodulator::get_fine_freq_corr(Csdr::complex<float> *input) {
+    constexpr int Tg = M.guard_length;
+    constexpr int prs_start = M.null_length;
     fftwf_complex *left;
     fftwf_complex *right;
     fftwf_complex *lr;
-    double angle[504];
+    double angle[Tg];
     double mean=0;
     double ffs;
-    left = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * 504);
-    right = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * 504);
-    lr = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * 504);
+    left = ws.guard;
+    right = ws.guard + Tg;
+    lr = ws.guard + 2 * Tg;
     uint32_t i;
-    for (i = 0; i < 504; i++) {
-        left[i][0] = input[2656 + 2048 + i].i();
-        left[i][1] = input[2656 + 2048 + i].q();
-        right[i][0] = input[2656 + i].i();
-        right[i][1] = input[2656 + i].q();
+    for (i = 0; i < Tg; i++) {
+        left[i][0] = input[prs_start + M.fft_size + i].i();
+        left[i][1] = input[prs_start + M.fft_size + i].q();
+        right[i][0] = input[prs_start + i].i();
+        right[i][1] = input[prs_start + i].q();
     }
-    for (i = 0; i < 504; i++){
+    for (i = 0; i < Tg; i++){
         lr[i][0] = (left[i][0] * right[i][0] - left[i][1] * (-1)*right[i][1]);
         lr[i][1] = (left[i][0] * (-1)*right[i][1] + left[i][1] * right[i][0]);
     }
 
-    for (i = 0; i < 504; i++){
+    for (i = 0; i < Tg; i++){
         angle[i] = atan2f(lr[i][1],lr[i][0]);
     }
-    for (i = 0; i < 504; i++){
+    for (i = 0; i < Tg; i++){
         mean = mean + angle[i];
     }
-    mean = (mean / 504);
+    mean = (mean / Tg);
     //printf("\n%f %f\n",left[0][0],left[0][1]);
     //printf("\n%f %f\n",right[0][0],right[0][1]);
     //printf("\n%f %f\n",lr[0][0],lr[0][1]);
     //printf("\n%f\n",angle[0]);
 
-    ffs = mean / (2 * M_PI) * 1000;
+    ffs = mean / (2 * M_PI) * M.carrier_spacing();
     //printf("\n%f\n",ffs);
 
-    fftwf_free(left);
-    fftwf_free(right);
-    fftwf_free(lr);
-
     return ffs;
-}
\ No newline at end of file
+}
+
+template <const dab_mode_t& M>
+bool EtiDemodulator::track_sync(Csdr::complex<float> *input, fftwf_complex *prs_received_fft) {
+    /* a timing offset of d samples turns the received prs into the known one times exp(2 pi j k d / N).
+       the phase step between neighbouring carriers gives d, its consistency tells whether we are still in sync. */
+    constexpr int K = M.carriers;
+    auto prs = (const fftwf_complex*) mode_tables<M>::prs.data();
+    float slope_re = 0, slope_im = 0, power = 0;
+    float prev_re = 0, prev_im = 0;
+    for (int k = 0; k < K; k++) {
+        const float* r = prs_received_fft[mode_tables<M>::bin(k)];
+        float re = r[0] * prs[k][0] + r[1] * prs[k][1];
+        float im = r[1] * prs[k][0] - r[0] * prs[k][1];
+        // no neighbour below the first carrier, and the center carrier between K/2 - 1 and K/2 is not transmitted
+        if (k != 0 && k != K / 2) {
+            slope_re += re * prev_re + im * prev_im;
+            slope_im += im * prev_re - re * prev_im;
+        }
+        power += re * re + im * im;
+        prev_re = re;
+        prev_im = im;
+    }
+
+    if (slope_re * slope_re + slope_im * slope_im < TRACK_MIN_COHERENCE * TRACK_MIN_COHERENCE * power * power) {
+        followSampleClock(0);
+        fine_freq_shift = 0;
+        return false;
+    }
+
+    // positive if the frame started late, so the next one has to start earlier. the target is not the start of the
+    // useful part of the symbols but the margin before it.
+    float timing = atan2f(slope_im, slope_re) * M.fft_size / (2 * M_PI) + M.fft_size / SYNC_GUARD_MARGIN;
+    if (fabsf(timing) > TRACK_TIMING_WINDOW) {
+        followSampleClock(0);
+        fine_freq_shift = 0;
+        return false;
+    }
+    followSampleClock(timing);
+
+    /* fine frequency from the phase of the guard interval correlation as a whole */
+    float corr_re = 0, corr_im = 0;
+    for (int i = 0; i < M.guard_length; i++) {
+        const Csdr::complex<float>& l = input[M.null_length + M.fft_size + i];
+        const Csdr::complex<float>& r = input[M.null_length + i];
+        corr_re += l.i() * r.i() + l.q() * r.q();
+        corr_im += l.q() * r.i() - l.i() * r.q();
+    }
+    fine_freq_shift = atan2f(corr_im, corr_re) / (2 * M_PI) * M.carrier_spacing();
+
+    return true;
+}
+
+void EtiDemodulator::restartAcquisition() {
+    sync_state = SyncState::ACQUIRING;
+    // the drift was estimated from the frames tracking was lost on, so acquisition starts over without it
+    sample_clock_drift = 0;
+    timing_fraction = 0;
+}
+
+void EtiDemodulator::followSampleClock(double timing_error) {
+    /* the timing error of each frame is corrected right away, while its trend is taken as the sample clock offset.
+       the frame is advanced by the drift expected from that offset, so the error stays close to zero. */
+    sample_clock_drift -= TRACK_CLOCK_GAIN * timing_error;
+    timing_fraction += sample_clock_drift - timing_error;
+    fine_timeshift = (int32_t) lrint(timing_fraction);
+    timing_fraction -= fine_timeshift;
+
+    double ppm = sample_clock_drift / dab->mode->frame_length() * 1e6;
+    if (fabs(ppm - reported_clock_offset) >= 0.1) {
+        reported_clock_offset = ppm;
+        sendMetaData({ {"sample_clock_offset", ppm} });
+    }
+}
+
+template <typename T>
+EtiDecoderT<T>::EtiDecoderT(unsigned int planningFlags): EtiDemodulator(planningFlags) {
+    if constexpr (std::is_same_v<T, unsigned char>) {
+        convert_input = convert_cu8;
+    } else if constexpr (std::is_same_v<T, short>) {
+        convert_input = convert_cs16;
+    }
+    input_sample_size = sizeof(Csdr::complex<T>);
+    dab->eti_callback = [this](uint8_t* eti) {
+        // writer cannot accept data. discard...
+        if (this->writer->writeable() < 6144) return;
+        std::memcpy(this->writer->getWritePointer(), eti, 6144);
+        this->writer->advance(6144);
+    };
+}
+
+template <typename T>
+EtiDecoderT<T>::~EtiDecoderT() {
+    // the decoding thread writes to this module's writer
+    setPipelined(false);
+}
+
+template <typename T>
+bool EtiDecoderT<T>::canProcess() {
+    return frameAvailable();
+}
+
+template <typename T>
+void EtiDecoderT<T>::process() {
+    processFrame();
+}
+
+template <typename T>
+const void* EtiDecoderT<T>::rawInput() {
+    return this->reader->getReadPointer();
+}
+
+template <typename T>
+size_t EtiDecoderT<T>::rawAvailable() {
+    return this->reader->available();
+}
+
+template <typename T>
+void EtiDecoderT<T>::rawAdvance(size_t samples) {
+    this->reader->advance(samples);
+}
+
+namespace Csdr::Eti {
+    template class EtiDecoderT<float>;
+    template class EtiDecoderT<short>;
+    template class EtiDecoderT<unsigned char>;
+}
@@ -4,34 +4,128 @@
 #include "dab.hpp"
 #include "fic.hpp"
 #include "misc.hpp"
+#include "decode_pool.hpp"
 
 extern "C" {
 #include "viterbi.h"
 };
 
+const struct dab_mode_t* dab_get_mode(int id) {
+    switch (id) {
+        case 1: return &dab_mode_1;
+        case 2: return &dab_mode_2;
+        case 3: return &dab_mode_3;
+        case 4: return &dab_mode_4;
+        default: return nullptr;
+    }
+}
+
 struct dab_state_t* init_dab_state() {
     struct dab_state_t* dab = new dab_state_t();
+    dab_set_mode(dab, &dab_mode_1);
 
     dab->ens_info.CIFCount_hi = 0xff;
     dab->ens_info.CIFCount_lo = 0xff;
 
-    init_viterbi();
+    /* Large enough for the biggest possible subchannel (a full CIF) */
+    dab->viterbi = create_viterbi(3072 * 18, SYMBOL_AMPLITUDE);
 
     return dab;
 }
 
-tf_info_t dab_process_frame(struct dab_state_t *dab) {
+void destroy_dab_state(struct dab_state_t *dab) {
+    dab_set_threads(dab, 1);
+    delete_viterbi(dab->viterbi);
+    delete[] dab->eti_tasks;
+    delete dab;
+}
+
+static void cif_ring_clear(struct cif_ring_t *ring) {
+    ring->head = 0;
+    ring->count = 0;
+    ring->good = 0;
+    ring->seq = -1;
+}
+
+/* The CIF count the next CIF pushed should have, -1 if it is not known */
+static int cif_ring_next(struct cif_ring_t *ring) {
+    if (ring->seq < 0) return -1;
+    return (ring->seq + ring->count) % CIF_COUNT_MODULO;
+}
+
+static void cif_ring_push(struct cif_ring_t *ring, unsigned char* msc, unsigned char* fibs, const cif_cu_set_t& demapped, bool good) {
+    int slot = (ring->head + ring->count) % CIF_RING_SIZE;
+    ring->msc[slot] = ring->msc[slot + CIF_RING_SIZE] = msc;
+    ring->fibs[slot] = ring->fibs[slot + CIF_RING_SIZE] = fibs;
+    ring->demapped[slot] = ring->demapped[slot + CIF_RING_SIZE] = demapped;
+    ring->count++;
+    ring->good = good ? ring->good + 1 : 0;
+}
+
+/* Drop the n oldest CIFs */
+static void cif_ring_pop(struct cif_ring_t *ring, int n) {
+    ring->head = (ring->head + n) % CIF_RING_SIZE;
+    ring->count -= n;
+    if (ring->good > ring->count) ring->good = ring->count;
+    if (ring->seq >= 0) ring->seq = (ring->seq + n) % CIF_COUNT_MODULO;
+}
+
+/* The ETI CIF count of the oldest CIF in the ring: its CIF count from FIG 0/0
+   once that is known, else our own count carries on, from 0 at the start */
+static void sync_cif_count(struct dab_state_t *dab) {
+    struct ens_info_t *info = &dab->ens_info;
+    int seq = dab->cifs.seq;
+    if (seq < 0) {
+        if (info->CIFCount_hi != 0xff) return;
+        seq = 0;
+    }
+    info->CIFCount_hi = seq / 250;
+    info->CIFCount_lo = seq % 250;
+}
+
+void dab_set_mode(struct dab_state_t *dab, const struct dab_mode_t *mode) {
+    dab->mode = mode;
+    dab->locked = false;
+    dab->okcount = 0;
+    cif_ring_clear(&dab->cifs);
+
+    delete[] dab->eti_tasks;
+    dab->eti_tasks = new eti_task_t[mode->cifs * MAX_SUBCHANNELS];
+}
+
+void dab_set_threads(struct dab_state_t *dab, int threads) {
+    if (dab->pool != nullptr) {
+        destroy_decode_pool(dab->pool);
+        dab->pool = nullptr;
+    }
+    for (auto vd: dab->pool_viterbi) {
+        delete_viterbi(vd);
+    }
+    dab->pool_viterbi.clear();
+
+    if (threads > 1) {
+        dab->pool = create_decode_pool(threads);
+        for (int t = 1; t < threads; t++) {
+            dab->pool_viterbi.push_back(create_viterbi(3072 * 18, SYMBOL_AMPLITUDE));
+        }
+    }
+}
+
+tf_info_t dab_process_frame(struct dab_state_t *dab, struct demapped_transmission_frame_t *tf) {
     int i;
     struct tf_info_t tf_info{};
+    const struct dab_mode_t *mode = dab->mode;
+    struct cif_ring_t *ring = &dab->cifs;
 
-    fic_decode(&dab->tfs[dab->tfidx]);
-    if (dab->tfs[dab->tfidx].fibs.ok_count > 0) {
-        //fprintf(stderr,"Decoded FIBs - ok_count=%d\n",dab->tfs[dab->tfidx].fibs.ok_count);
-        tf_info = fib_decode( &dab->tfs[dab->tfidx].fibs,12);
+    fic_decode(dab->viterbi, mode, tf);
+    if (tf->fibs.ok_count > 0) {
+        //fprintf(stderr,"Decoded FIBs - ok_count=%d\n",tf->fibs.ok_count);
+        tf_info = fib_decode(&tf->fibs, tf->fibs.count, mode->fibs_per_cif);
         //dump_tf_info(&dab->tf_info);
     }
 
-    if (dab->tfs[dab->tfidx].fibs.ok_count >= FIB_CRC_LOCK_VALUE_TRESHOLD) {
+    bool good = tf->fibs.ok_count * 4 >= tf->fibs.count * FIB_CRC_LOCK_VALUE_TRESHOLD;
+    if (good) {
         dab->okcount++;
         if ((dab->okcount >= FIB_CRC_LOCK_COUNT_TRESHOLD) && (!dab->locked)) { // certain amount of successive relatively perfect sets of FICs, we are locked.
             dab->locked = true;
@@ -41,52 +135,57 @@ tf_info_t dab_process_frame(struct dab_state_t *dab) {
     } else {
         dab->okcount = 0;
         if (dab->locked) {
+            /* The CIF history stays, so the output can carry on as soon as the lock is back */
             dab->locked = false;
-            fprintf(stderr,"Lock lost, resetting ringbuffer\n");
-            dab->ncifs = 0;
-            dab->tfidx = 0;
-            return tf_info;
+            fprintf(stderr,"Lock lost\n");
         }
     }
 
     if (dab->locked) {
-        int wrong_fibs = 12 - dab->tfs[dab->tfidx].fibs.ok_count;
+        int wrong_fibs = tf->fibs.count - tf->fibs.ok_count;
         if (wrong_fibs > 0)
             fprintf(stderr, "Received %d FIBs with CRC mismatch\n", wrong_fibs);
 
         merge_info(&dab->ens_info, &tf_info);  /* Only merge the info once we are locked */
-        if (dab->ncifs < 16) {
-            /* Initial buffer fill */
-            //fprintf(stderr,"Initial buffer fill - dab->ncifs=%d, dab->tfidx=%d\n",dab->ncifs,dab->tfidx);
-            dab->cifs_fibs[dab->ncifs] = dab->tfs[dab->tfidx].fibs.FIB[0];
-            dab->cifs_msc[dab->ncifs++] = dab->tfs[dab->tfidx].msc_symbols_demapped[0];
-            dab->cifs_fibs[dab->ncifs] = dab->tfs[dab->tfidx].fibs.FIB[3];
-            dab->cifs_msc[dab->ncifs++] = dab->tfs[dab->tfidx].msc_symbols_demapped[18];
-            dab->cifs_fibs[dab->ncifs] = dab->tfs[dab->tfidx].fibs.FIB[6];
-            dab->cifs_msc[dab->ncifs++] = dab->tfs[dab->tfidx].msc_symbols_demapped[36];
-            dab->cifs_fibs[dab->ncifs] = dab->tfs[dab->tfidx].fibs.FIB[9];
-            dab->cifs_msc[dab->ncifs++] = dab->tfs[dab->tfidx].msc_symbols_demapped[54];
-        } else {
+    }
+
+    /* The CIFs have to follow on from the history, or it is of no use for the time deinterleaving */
+    int next = cif_ring_next(ring);
+    if ((tf_info.cif_count >= 0) && (next >= 0) && (tf_info.cif_count != next)) {
+        fprintf(stderr,"CIF count jumped from %d to %d, dropping %d buffered CIFs\n",next,tf_info.cif_count,ring->count);
+        cif_ring_clear(ring);
+    }
+    if ((ring->seq < 0) && (tf_info.cif_count >= 0)) {
+        ring->seq = (tf_info.cif_count - ring->count + CIF_COUNT_MODULO) % CIF_COUNT_MODULO;
+    }
+
+    /* Every frame goes into the history, locked or not. The FIBs are kept with the CIFs, the frame is reused once it
+       has been processed. */
+    for (i=0;i<mode->cifs;i++) {
+        struct cif_buffer_t *cif = tf->cifs[i];
+        memcpy(cif->fibs, tf->fibs.FIB[i*mode->fibs_per_cif], mode->fibs_per_cif * 32);
+        cif_ring_push(ring, cif->msc, cif->fibs[0], demapped_cus(dab, tf->msc_demapped, i), good);
+    }
+
+    /* Any CIF with 16 more after it can be output: CIF c is time-deinterleaved
+       from the 16 CIFs starting at c. Those reaching back to a frame with a bad
+       FIC are skipped, as is everything while there is no lock. */
+    int n = ring->count - 16;
+    if (n > 0) {
+        sync_cif_count(dab);
+        int skip = dab->locked ? ring->count - ring->good : n;
+        if (skip > n) skip = n;
+        if (skip > 0) {
+            skip_eti(dab, skip);
+        }
+        if (skip < n) {
             if (!dab->ens_info_shown) {
                 dump_ens_info(&dab->ens_info);
-                //for (i=0;i<16;i++) { fprintf(stderr,"cifs_msc[%d]=%d\n",i,(int)cifs_msc[i]); }
                 dab->ens_info_shown = true;
             }
-            /* We have a full history of 16 CIFs, so we can output the
-               oldest TF, which we do one CIF at a time */
-            for (i=0;i<4;i++) {
-                create_eti(dab);
-
-                /* Discard earliest CIF to make room for new one (note we are only copying 15 pointers, not the data) */
-                memmove(dab->cifs_fibs,dab->cifs_fibs+1,sizeof(dab->cifs_fibs[0])*15);
-                memmove(dab->cifs_msc,dab->cifs_msc+1,sizeof(dab->cifs_msc[0])*15);
-
-                /* Add our new CIF to the end */
-                dab->cifs_fibs[15] = dab->tfs[dab->tfidx].fibs.FIB[i*3];
-                dab->cifs_msc[15] = dab->tfs[dab->tfidx].msc_symbols_demapped[i*18];
-            }
+            create_eti(dab, &ring->msc[ring->head + skip], &ring->fibs[ring->head + skip], &ring->demapped[ring->head + skip], n - skip);
         }
-        dab->tfidx = (dab->tfidx + 1) % 5;
+        cif_ring_pop(ring, n);
     }
 
     return tf_info;
@@ -27,8 +27,6 @@ extern const struct eepprof eeptable[];
 extern const struct eepprof eep2a8kbps;
 extern const char pvec[][32];
 
-extern const uint16_t rev_freq_deint_tab[1536];
-
 #endif
 
 
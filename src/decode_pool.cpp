@@ -0,0 +1,150 @@
+/* Work-stealing thread pool for the MSC decoding.
+ *
+ * All tasks of a batch are known up front, so the queue of each thread is just
+ * a range of task indices, packed into one 64 bit word. The owner takes tasks
+ * from the front and thieves take them from the back, both with a compare and
+ * swap on the same word, which needs no locks. The mutex and condition
+ * variables only wake the threads up for a batch and tell the caller that the
+ * batch is done.
+ */
+
+#include "decode_pool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct alignas(64) task_range {
+    /* first task in the upper 32 bits, end of the range in the lower ones */
+    std::atomic<uint64_t> range {0};
+};
+
+struct decode_pool {
+    int threads;
+    std::vector<std::thread> workers;
+    std::unique_ptr<task_range[]> queues;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    uint64_t batch = 0;
+    bool stop = false;
+    const std::function<void(int task, int thread)>* task = nullptr;
+    std::atomic<int> remaining {0};
+    int busy = 0;
+};
+
+static inline uint64_t pack(uint32_t first, uint32_t end) {
+    return ((uint64_t) first << 32) | end;
+}
+
+/* take the first task of the own range, -1 if it is empty */
+static int take(task_range& q) {
+    uint64_t r = q.range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t first = r >> 32, end = (uint32_t) r;
+        if (first >= end) return -1;
+        if (q.range.compare_exchange_weak(r, pack(first + 1, end), std::memory_order_acq_rel)) return (int) first;
+    }
+}
+
+/* take the last task of somebody else's range, -1 if it is empty */
+static int steal(task_range& q) {
+    uint64_t r = q.range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t first = r >> 32, end = (uint32_t) r;
+        if (first >= end) return -1;
+        if (q.range.compare_exchange_weak(r, pack(first, end - 1), std::memory_order_acq_rel)) return (int) end - 1;
+    }
+}
+
+static void work(struct decode_pool* pool, int thread, const std::function<void(int task, int thread)>& task) {
+    int done = 0;
+    for (;;) {
+        int t = take(pool->queues[thread]);
+        // when out of work, go through the others, starting with the next one
+        for (int v = 1; t < 0 && v < pool->threads; v++) {
+            t = steal(pool->queues[(thread + v) % pool->threads]);
+        }
+        if (t < 0) break;
+        task(t, thread);
+        done++;
+    }
+    pool->remaining.fetch_sub(done, std::memory_order_acq_rel);
+}
+
+static void worker(struct decode_pool* pool, int thread) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    for (;;) {
+        pool->start.wait(lock, [pool, seen] { return pool->stop || pool->batch != seen; });
+        if (pool->stop) return;
+        seen = pool->batch;
+        // a thread that only gets here after the batch is over has nothing left to do
+        auto task = pool->task;
+        if (task == nullptr) continue;
+        pool->busy++;
+        lock.unlock();
+        work(pool, thread, *task);
+        lock.lock();
+        if (--pool->busy == 0) pool->done.notify_all();
+    }
+}
+
+struct decode_pool* create_decode_pool(int threads) {
+    auto pool = new decode_pool();
+    pool->threads = threads < 1 ? 1 : threads;
+    pool->queues.reset(new task_range[pool->threads]);
+    for (int t = 1; t < pool->threads; t++) {
+        pool->workers.emplace_back(worker, pool, t);
+    }
+    return pool;
+}
+
+void destroy_decode_pool(struct decode_pool* pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->stop = true;
+        pool->start.notify_all();
+    }
+    for (auto& w: pool->workers) w.join();
+    delete pool;
+}
+
+int decode_pool_threads(struct decode_pool* pool) {
+    return pool->threads;
+}
+
+void decode_pool_run(struct decode_pool* pool, int ntasks, const std::function<void(int task, int thread)>& task) {
+    if (ntasks == 0) return;
+    if (pool->threads == 1 || ntasks == 1) {
+        for (int t = 0; t < ntasks; t++) task(t, 0);
+        return;
+    }
+
+    {
+        // a thread still waking up for the last batch must see either all of this one or nothing of it
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        // an even share of the tasks for every thread to begin with
+        for (int q = 0; q < pool->threads; q++) {
+            uint32_t first = (uint32_t) ((int64_t) ntasks * q / pool->threads);
+            uint32_t end = (uint32_t) ((int64_t) ntasks * (q + 1) / pool->threads);
+            pool->queues[q].range.store(pack(first, end), std::memory_order_relaxed);
+        }
+        pool->remaining.store(ntasks, std::memory_order_relaxed);
+        pool->task = &task;
+        pool->batch++;
+        pool->start.notify_all();
+    }
+
+    work(pool, 0, task);
+
+    // the tasks are all taken, wait for the ones still running and for every thread to leave the batch
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    pool->done.wait(lock, [pool] { return pool->busy == 0 && pool->remaining.load(std::memory_order_acquire) == 0; });
+    pool->task = nullptr;
+}
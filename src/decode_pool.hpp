@@ -0,0 +1,20 @@
+#pragma once
+
+#include <functional>
+
+/* A pool of threads for the independent tasks of decoding a transmission
+   frame. Every thread starts on its own share of the tasks and steals from
+   the others once it runs out, so uneven task sizes still keep all of them
+   busy until the end. */
+
+struct decode_pool;
+
+/* threads is the total number of threads, including the one calling decode_pool_run() */
+struct decode_pool* create_decode_pool(int threads);
+void destroy_decode_pool(struct decode_pool* pool);
+int decode_pool_threads(struct decode_pool* pool);
+
+/* Run task(index, thread) for every index from 0 to ntasks - 1 and return when
+   all are done. thread is 0 for the calling thread and 1 to threads - 1 for the
+   others, and tells which per-thread resources a task may use. */
+void decode_pool_run(struct decode_pool* pool, int ntasks, const std::function<void(int task, int thread)>& task);
@@ -0,0 +1,164 @@
+/* Time deinterleaving of the MSC, 32 bits at a time.
+ *
+ * Within every aligned block of 16 bits, bit k comes from CIF map[k], and
+ * map is a permutation. So a block is put together from the same 8 packed
+ * bytes of all 16 CIFs, taking one nibble out of each: a masked select per
+ * CIF, with the mask of CIF c only set in the nibble that comes from c. A
+ * 16 byte register holds two blocks, as the pattern repeats every 16 bits,
+ * and the result is unpacked into one Viterbi input symbol per bit.
+ */
+
+#include "deinterleave.hpp"
+#include "dab.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define DEINTERLEAVE_SSE2
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DEINTERLEAVE_NEON
+#endif
+
+// the vector kernels multiply the nibbles with a shift
+static_assert(PACKED_SYMBOL(1) - PACKED_SYMBOL(0) == 8, "unpacking assumes steps of 8");
+
+static constexpr int map[16] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
+
+#if defined(DEINTERLEAVE_SSE2) || defined(DEINTERLEAVE_NEON)
+
+/* nibble masks: select_mask[c][b] selects the nibbles of packed byte b that come from CIF c */
+struct select_masks {
+    alignas(16) uint8_t mask[16][16];
+    constexpr select_masks() : mask() {
+        for (int b = 0; b < 16; b++) {
+            mask[map[(2 * b) & 15]][b] |= 0x0f;
+            mask[map[(2 * b + 1) & 15]][b] |= 0xf0;
+        }
+    }
+};
+
+static constexpr select_masks select_mask;
+
+#endif
+
+/* bits first to last, dst pointing at the symbol of bit first */
+static void scalar(uint8_t* dst, uint8_t* const cifs[16], int first, int last) {
+    for (int i = first; i < last; i++) {
+        int n = (cifs[map[i & 15]][i >> 1] >> ((i & 1) * 4)) & 0x0f;
+        dst[i - first] = PACKED_SYMBOL(n);
+    }
+}
+
+static void kernel_generic(uint8_t* dst, uint8_t* const cifs[16], int first, int n) {
+    scalar(dst, cifs, first, first + n);
+}
+
+#ifdef DEINTERLEAVE_SSE2
+
+/* the 32 nibbles of r as symbols, the low nibble of each byte first */
+static inline void unpack_sse2(__m128i r, uint8_t* dst) {
+    const __m128i low = _mm_set1_epi8(0x0f);
+    const __m128i base = _mm_set1_epi8((char) PACKED_SYMBOL(0));
+    __m128i lo = _mm_and_si128(r, low);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(r, 4), low);
+    // no nibble shifted by 3 reaches the next byte
+    __m128i a = _mm_slli_epi16(_mm_unpacklo_epi8(lo, hi), 3);
+    __m128i b = _mm_slli_epi16(_mm_unpackhi_epi8(lo, hi), 3);
+    _mm_storeu_si128((__m128i*) dst, _mm_add_epi8(a, base));
+    _mm_storeu_si128((__m128i*) (dst + 16), _mm_add_epi8(b, base));
+}
+
+static void kernel_sse2(uint8_t* dst, uint8_t* const cifs[16], int first, int n) {
+    int end = first + n;
+    int i = (first + 15) & ~15;
+    if (i > end) i = end;
+    scalar(dst, cifs, first, i);
+    for (; i + 32 <= end; i += 32) {
+        __m128i r = _mm_setzero_si128();
+        for (int c = 0; c < 16; c++) {
+            __m128i v = _mm_loadu_si128((const __m128i*) (cifs[c] + i / 2));
+            r = _mm_or_si128(r, _mm_and_si128(v, _mm_load_si128((const __m128i*) select_mask.mask[c])));
+        }
+        unpack_sse2(r, dst + (i - first));
+    }
+    scalar(dst + (i - first), cifs, i, end);
+}
+
+__attribute__((target("avx2")))
+static void kernel_avx2(uint8_t* dst, uint8_t* const cifs[16], int first, int n) {
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    const __m256i base = _mm256_set1_epi8((char) PACKED_SYMBOL(0));
+    int end = first + n;
+    int i = (first + 15) & ~15;
+    if (i > end) i = end;
+    scalar(dst, cifs, first, i);
+    // the masks stay in registers
+    __m256i m[16];
+    for (int c = 0; c < 16; c++) {
+        m[c] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) select_mask.mask[c]));
+    }
+    for (; i + 64 <= end; i += 64) {
+        __m256i r = _mm256_setzero_si256();
+        for (int c = 0; c < 16; c++) {
+            r = _mm256_or_si256(r, _mm256_and_si256(_mm256_loadu_si256((const __m256i*) (cifs[c] + i / 2)), m[c]));
+        }
+        __m256i lo = _mm256_and_si256(r, low);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(r, 4), low);
+        // the unpacking works within 128 bit lanes, so the halves are put back in order afterwards
+        __m256i a = _mm256_slli_epi16(_mm256_unpacklo_epi8(lo, hi), 3);
+        __m256i b = _mm256_slli_epi16(_mm256_unpackhi_epi8(lo, hi), 3);
+        _mm256_storeu_si256((__m256i*) (dst + (i - first)), _mm256_add_epi8(_mm256_permute2x128_si256(a, b, 0x20), base));
+        _mm256_storeu_si256((__m256i*) (dst + (i - first) + 32), _mm256_add_epi8(_mm256_permute2x128_si256(a, b, 0x31), base));
+    }
+    // an odd pair of blocks at the end
+    kernel_sse2(dst + (i - first), cifs, i, end - i);
+}
+
+#endif
+
+#ifdef DEINTERLEAVE_NEON
+
+static void kernel_neon(uint8_t* dst, uint8_t* const cifs[16], int first, int n) {
+    const uint8x16_t low = vdupq_n_u8(0x0f);
+    const uint8x16_t base = vdupq_n_u8(PACKED_SYMBOL(0));
+    int end = first + n;
+    int i = (first + 15) & ~15;
+    if (i > end) i = end;
+    scalar(dst, cifs, first, i);
+    for (; i + 32 <= end; i += 32) {
+        uint8x16_t r = vdupq_n_u8(0);
+        for (int c = 0; c < 16; c++) {
+            r = vbslq_u8(vld1q_u8(select_mask.mask[c]), vld1q_u8(cifs[c] + i / 2), r);
+        }
+        uint8x16x2_t z = vzipq_u8(vandq_u8(r, low), vshrq_n_u8(r, 4));
+        vst1q_u8(dst + (i - first), vaddq_u8(vshlq_n_u8(z.val[0], 3), base));
+        vst1q_u8(dst + (i - first) + 16, vaddq_u8(vshlq_n_u8(z.val[1], 3), base));
+    }
+    scalar(dst + (i - first), cifs, i, end);
+}
+
+#endif
+
+deinterleave_kernel deinterleave_select(const char** name) {
+    deinterleave_kernel kernel = kernel_generic;
+    const char* kernel_name = "generic";
+
+#ifdef DEINTERLEAVE_SSE2
+    kernel = kernel_sse2;
+    kernel_name = "sse2";
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernel = kernel_avx2;
+        kernel_name = "avx2";
+    }
+#endif
+#ifdef DEINTERLEAVE_NEON
+    kernel = kernel_neon;
+    kernel_name = "neon";
+#endif
+
+    if (name != nullptr) *name = kernel_name;
+    return kernel;
+}
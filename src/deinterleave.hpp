@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+/* Time deinterleaving of the MSC: bit i of a CIF is delayed by a number of
+   CIFs that only depends on i % 16, so with cifs[0] the oldest of the 16 CIFs
+   it is spread over, bit i comes from cifs[map[i % 16]] for the n bits from
+   bit first on. The CIFs are packed, dst receives one Viterbi input symbol
+   per bit, dst[0] being that of bit first. */
+typedef void (*deinterleave_kernel)(uint8_t* dst, uint8_t* const cifs[16], int first, int n);
+
+/* Fastest kernel for this CPU. If name is not NULL, it receives a description of the kernel. */
+deinterleave_kernel deinterleave_select(const char** name);
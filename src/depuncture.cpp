@@ -19,108 +19,58 @@
     along with OpenDAB.  If not, see <http://www.gnu.org/licenses/>.
 */
 /*
-** MSC UEP and EEP depuncturing
+** Puncturing plans for the FIC and the MSC UEP and EEP profiles
 */
 
-#include "dab.hpp"
+#include "depuncture.hpp"
 extern "C" {
 #include "dab_tables.h"
 }
 
 #define BLKSIZE 128
 
-/* Viterbi symbol values 0->127 1->129 erasure->128 */
-#define OFFSET 128
+/* Trellis steps (data bits) per block, the mother code has 4 symbols per bit */
+#define BLKSTEPS (BLKSIZE/4)
 
-/* 0 is a "strong 0" and 255 is a "strong 1" */
-static inline int to_viterbi(int x)
+/* The FIBs of one CIF, 3 in Mode I, II and IV, 4 in Mode III */
+void fic_puncturing(struct viterbi_puncturing *p, int nfibs)
 {
-    return (OFFSET-1) + 2*x;
+    *p = {};
+    viterbi_add_segment(p, (nfibs*8-3)*BLKSTEPS, pvec[15]);
+    viterbi_add_segment(p, 3*BLKSTEPS, pvec[14]);
+    /* Remaining 24 bits using rate 8/16 */
+    viterbi_add_segment(p, 24/4, pvec[7]);
 }
 
-void fic_depuncture(uint8_t *obuf, uint8_t *inbuf)
+void uep_puncturing(struct viterbi_puncturing *p, struct subchannel_info_t *s)
 {
-    int i,j;
+    int indx;
+    const struct uepprof prof = ueptable[s->uep_index];
 
-    for (i=0; i<21*BLKSIZE; i+=32)
-    {
-        for (j=0; j<8; j++)
-        {
-            *(obuf++) = to_viterbi(*(inbuf++));
-            *(obuf++) = to_viterbi(*(inbuf++));
-            *(obuf++) = to_viterbi(*(inbuf++));
-            *(obuf++) = OFFSET;
-        }
-    }
-    for (i=21*BLKSIZE; i<24*BLKSIZE; i+=32)
-    {
-        for (j=0; j<7; j++)
-        {
-            *(obuf++) = to_viterbi(*(inbuf++));
-            *(obuf++) = to_viterbi(*(inbuf++));
-            *(obuf++) = to_viterbi(*(inbuf++));
-            *(obuf++) = OFFSET;
-        }
-        *(obuf++) = to_viterbi(*(inbuf++));
-        *(obuf++) = to_viterbi(*(inbuf++));
-        *(obuf++) = OFFSET;
-        *(obuf++) = OFFSET;
-    }
-    for (j=0; j<6; j++)
-    {
-        *(obuf++) = to_viterbi(*(inbuf++));
-        *(obuf++) = to_viterbi(*(inbuf++));
-        *(obuf++) = OFFSET;
-        *(obuf++) = OFFSET;
-    }
-}
-
-void uep_depuncture(uint8_t *obuf, uint8_t *inbuf, struct subchannel_info_t *s, int* len)
-{
-    int i, j, k, indx;
-    const struct uepprof p = ueptable[s->uep_index];
-
-    j = 0;
-    k = 0;
+    *p = {};
     for (indx=0; indx < 4; indx++)
-        for (i=0; i < BLKSIZE * p.l[indx]; i++) {
-            if (pvec[p.pi[indx]][i % 32])
-                *(obuf + k++) = to_viterbi(*(inbuf + j++));
-            else
-                *(obuf + k++) = OFFSET;
-        }
-    /* Depuncture remaining 24 bits using rate 8/16 */
-    for (i=0; i < 24; i++)
-        if (pvec[7][i % 32])
-            *(obuf + k++) = to_viterbi(*(inbuf + j++));
-        else
-            *(obuf + k++) = OFFSET;
-    *len = k;
+        if (prof.l[indx] > 0)
+            viterbi_add_segment(p, BLKSTEPS * prof.l[indx], pvec[prof.pi[indx]]);
+    /* Remaining 24 bits using rate 8/16 */
+    viterbi_add_segment(p, 24/4, pvec[7]);
 }
 
-void eep_depuncture(uint8_t *obuf, uint8_t *inbuf, struct subchannel_info_t *s, int* len)
+void eep_puncturing(struct viterbi_puncturing *p, struct subchannel_info_t *s)
 {
-    int i, j, k, n, indx;
-    struct eepprof p = eeptable[s->protlev];
+    int n, l, indx;
+    struct eepprof prof = eeptable[s->protlev];
 
     /* Special case for bitrate == 8 with EEP 2-A */
     if ((s->bitrate == 8) && (s->protlev == 1))
-        p = eep2a8kbps;
-    j = 0;
-    k = 0;
-    n = s->size/p.sizemul;
-    for (indx=0; indx < 2; indx++)
-        for (i=0; i < BLKSIZE * (p.l[indx].mul * n + p.l[indx].offset); i++) {
-            if (pvec[p.pi[indx]][i % 32])
-                *(obuf + k++) = to_viterbi(*(inbuf + j++));
-            else
-                *(obuf + k++) = OFFSET;
-        }
-    /* Depuncture remaining 24 bits using rate 8/16 */
-    for (i=0; i < 24; i++)
-        if (pvec[7][i % 32])
-            *(obuf + k++) = to_viterbi(*(inbuf + j++));
-        else
-            *(obuf + k++) = OFFSET;
-    *len = k;
+        prof = eep2a8kbps;
+    n = s->size/prof.sizemul;
+
+    *p = {};
+    for (indx=0; indx < 2; indx++) {
+        l = prof.l[indx].mul * n + prof.l[indx].offset;
+        if (l > 0)
+            viterbi_add_segment(p, BLKSTEPS * l, pvec[prof.pi[indx]]);
+    }
+    /* Remaining 24 bits using rate 8/16 */
+    viterbi_add_segment(p, 24/4, pvec[7]);
 }
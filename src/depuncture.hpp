@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include "dab.hpp"
+extern "C" {
+#include "viterbi.h"
+}
 
-void fic_depuncture(uint8_t *obuf, uint8_t *inbuf);
-void uep_depuncture(uint8_t *obuf, uint8_t *inbuf, struct subchannel_info_t *s, int* len);
-void eep_depuncture(uint8_t *obuf, uint8_t *inbuf, struct subchannel_info_t *s, int* len);
+void fic_puncturing(struct viterbi_puncturing *p, int nfibs);
+void uep_puncturing(struct viterbi_puncturing *p, struct subchannel_info_t *s);
+void eep_puncturing(struct viterbi_puncturing *p, struct subchannel_info_t *s);
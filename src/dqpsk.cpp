@@ -0,0 +1,224 @@
+/* Differential QPSK demodulation, frequency deinterleaving and demapping of
+ * one OFDM symbol.
+ *
+ * The real and imaginary parts of z[j] / z[j-1] have the same signs as those
+ * of z[j-1] * conj(z[j]), so no division is done. Hard decisions only need
+ * these signs, which all kernels compute with the same operations in the
+ * same order. For soft decisions, the magnitude of the product scales with
+ * the power of the carrier, which makes it a measure of its reliability.
+ *
+ * The products are vectorized, the deinterleaving and demapping are a second,
+ * scalar pass over them: the deinterleaving is a scatter, which has no vector
+ * form short of AVX-512, and soft decisions are scaled by the mean amplitude
+ * of the whole symbol, which is only known once all products are done.
+ */
+
+#include "dqpsk.hpp"
+#include "dab.hpp"
+#include "mode_tables.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define DQPSK_SSE2
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DQPSK_NEON
+#endif
+
+static float kernel_generic(const fftwf_complex* cur, const fftwf_complex* prev, float* re, float* im, int n) {
+    float sum = 0;
+    for (int k = 0; k < n; k++) {
+        const float* c = cur[k];
+        const float* p = prev[k];
+        re[k] = c[0] * p[0] + c[1] * p[1];
+        im[k] = c[0] * p[1] - c[1] * p[0];
+        sum += fabsf(re[k]) + fabsf(im[k]);
+    }
+    return sum;
+}
+
+#ifdef DQPSK_SSE2
+
+static float kernel_sse2(const fftwf_complex* cur, const fftwf_complex* prev, float* re, float* im, int n) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 sum = _mm_setzero_ps();
+    for (int k = 0; k < n; k += 4) {
+        __m128 c0 = _mm_loadu_ps(cur[k]);
+        __m128 c1 = _mm_loadu_ps(cur[k + 2]);
+        __m128 p0 = _mm_loadu_ps(prev[k]);
+        __m128 p1 = _mm_loadu_ps(prev[k + 2]);
+        /* real and imaginary parts of 4 carriers each */
+        __m128 cr = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 ci = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 pr = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 pi = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 r = _mm_add_ps(_mm_mul_ps(cr, pr), _mm_mul_ps(ci, pi));
+        __m128 i = _mm_sub_ps(_mm_mul_ps(cr, pi), _mm_mul_ps(ci, pr));
+        _mm_storeu_ps(re + k, r);
+        _mm_storeu_ps(im + k, i);
+        sum = _mm_add_ps(sum, _mm_add_ps(_mm_and_ps(r, abs_mask), _mm_and_ps(i, abs_mask)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2")))
+static float kernel_avx2(const fftwf_complex* cur, const fftwf_complex* prev, float* re, float* im, int n) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 sum = _mm256_setzero_ps();
+    for (int k = 0; k < n; k += 8) {
+        __m256 c0 = _mm256_loadu_ps(cur[k]);
+        __m256 c1 = _mm256_loadu_ps(cur[k + 4]);
+        __m256 p0 = _mm256_loadu_ps(prev[k]);
+        __m256 p1 = _mm256_loadu_ps(prev[k + 4]);
+        /* (cr * pr, ci * pi) and (cr * pi, ci * pr) per carrier */
+        __m256 rr0 = _mm256_mul_ps(c0, p0);
+        __m256 rr1 = _mm256_mul_ps(c1, p1);
+        __m256 ri0 = _mm256_mul_ps(c0, _mm256_permute_ps(p0, 0xb1));
+        __m256 ri1 = _mm256_mul_ps(c1, _mm256_permute_ps(p1, 0xb1));
+        /* horizontal add / sub within 128-bit lanes leaves the carriers in order 0 1 4 5 2 3 6 7 */
+        __m256 r = _mm256_hadd_ps(rr0, rr1);
+        __m256 i = _mm256_hsub_ps(ri0, ri1);
+        r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), 0xd8));
+        i = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(i), 0xd8));
+        _mm256_storeu_ps(re + k, r);
+        _mm256_storeu_ps(im + k, i);
+        sum = _mm256_add_ps(sum, _mm256_add_ps(_mm256_and_ps(r, abs_mask), _mm256_and_ps(i, abs_mask)));
+    }
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+#endif
+
+#ifdef DQPSK_NEON
+
+static float kernel_neon(const fftwf_complex* cur, const fftwf_complex* prev, float* re, float* im, int n) {
+    float32x4_t sum = vdupq_n_f32(0);
+    for (int k = 0; k < n; k += 4) {
+        /* val[0] are the real parts, val[1] the imaginary parts of 4 carriers */
+        float32x4x2_t c = vld2q_f32(cur[k]);
+        float32x4x2_t p = vld2q_f32(prev[k]);
+        float32x4_t r = vaddq_f32(vmulq_f32(c.val[0], p.val[0]), vmulq_f32(c.val[1], p.val[1]));
+        float32x4_t i = vsubq_f32(vmulq_f32(c.val[0], p.val[1]), vmulq_f32(c.val[1], p.val[0]));
+        vst1q_f32(re + k, r);
+        vst1q_f32(im + k, i);
+        sum = vaddq_f32(sum, vaddq_f32(vabsq_f32(r), vabsq_f32(i)));
+    }
+#if defined(__aarch64__)
+    return vaddvq_f32(sum);
+#else
+    float32x2_t s = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+}
+
+#endif
+
+dqpsk_kernel dqpsk_select(const char** name) {
+    dqpsk_kernel kernel = kernel_generic;
+    const char* kernel_name = "generic";
+
+#ifdef DQPSK_SSE2
+    kernel = kernel_sse2;
+    kernel_name = "sse2";
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernel = kernel_avx2;
+        kernel_name = "avx2";
+    }
+#endif
+#ifdef DQPSK_NEON
+    kernel = kernel_neon;
+    kernel_name = "neon";
+#endif
+
+    if (name != nullptr) *name = kernel_name;
+    return kernel;
+}
+
+/* Soft symbol for a value normalized to +-1 for a noiseless carrier of average power */
+static inline uint8_t soft_symbol(float x) {
+    x = 128.5f + x * SYMBOL_AMPLITUDE;
+    if (x < 0) return 0;
+    if (x > 255) return 255;
+    return (uint8_t) x;
+}
+
+/* The same as a nibble of the packed MSC */
+static inline uint8_t soft_nibble(float x) {
+    x = 8.5f + x * 4;
+    if (x < 1) return 1;
+    if (x > 15) return 15;
+    return (uint8_t) x;
+}
+
+template <const dab_mode_t& M, bool packed>
+static void demap(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft) {
+    static const dqpsk_kernel kernel = dqpsk_select(nullptr);
+    constexpr int K = M.carriers;
+    constexpr const uint16_t* deinterleave = mode_tables<M>::deinterleave.data();
+    constexpr uint8_t symbol_0 = packed ? PACKED_0 : SYMBOL_0;
+    constexpr uint8_t symbol_1 = packed ? PACKED_1 : SYMBOL_1;
+    float re[K], im[K];
+    float sum;
+    int k, kk;
+    /* the nibbles are spread by the frequency deinterleaving, so they are packed in a second pass */
+    uint8_t nibbles[packed ? 2 * K : 1];
+    uint8_t* out = packed ? nibbles : dst;
+
+    /* the lower half of the carriers are the upper FFT bins, from bin N - K/2 on, the upper half bins 1..K/2 (the center carrier is unused) */
+    sum = kernel(cur + mode_tables<M>::bin(0), prev + mode_tables<M>::bin(0), re, im, K / 2);
+    sum += kernel(cur + 1, prev + 1, re + K / 2, im + K / 2, K / 2);
+
+    if (soft) {
+        /* the mean absolute value of the real and imaginary parts is what a noiseless carrier of average power has */
+        float scale = sum > 0 ? 2 * K / sum : 0;
+        for (k = 0; k < K; k++) {
+            /* Frequency deinterleaving and QPSK demapping combined */
+            kk = deinterleave[k];
+            out[kk] = packed ? soft_nibble(-re[k] * scale) : soft_symbol(-re[k] * scale);
+            out[K + kk] = packed ? soft_nibble(im[k] * scale) : soft_symbol(im[k] * scale);
+        }
+    } else {
+        for (k = 0; k < K; k++) {
+            /* Frequency deinterleaving and QPSK demapping combined */
+            kk = deinterleave[k];
+            out[kk] = re[k] > 0 ? symbol_0 : symbol_1;
+            out[K + kk] = im[k] > 0 ? symbol_1 : symbol_0;
+        }
+    }
+
+    if (packed) {
+        for (k = 0; k < K; k++) {
+            dst[k] = nibbles[2 * k] | (nibbles[2 * k + 1] << 4);
+        }
+    }
+}
+
+template <const dab_mode_t& M>
+void dqpsk_demap(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft) {
+    demap<M, false>(cur, prev, dst, soft);
+}
+
+template <const dab_mode_t& M>
+void dqpsk_demap_packed(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft) {
+    demap<M, true>(cur, prev, dst, soft);
+}
+
+template void dqpsk_demap<dab_mode_1>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+template void dqpsk_demap<dab_mode_2>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+template void dqpsk_demap<dab_mode_3>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+template void dqpsk_demap<dab_mode_4>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+
+template void dqpsk_demap_packed<dab_mode_1>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+template void dqpsk_demap_packed<dab_mode_2>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+template void dqpsk_demap_packed<dab_mode_3>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+template void dqpsk_demap_packed<dab_mode_4>(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include "dab.hpp"
+
+extern "C" {
+#include <fftw3.h>
+}
+
+/* Differential demodulation of n carriers (a multiple of 8): writes the
+   real and imaginary parts of prev[k] * conj(cur[k]) to re[k] and im[k] and
+   returns the sum of their absolute values. The signs are those of
+   cur[k] / prev[k], and the magnitude scales with the carrier power. */
+typedef float (*dqpsk_kernel)(const fftwf_complex* cur, const fftwf_complex* prev, float* re, float* im, int n);
+
+/* Fastest kernel for this CPU. If name is not NULL, it receives a description of the kernel. */
+dqpsk_kernel dqpsk_select(const char** name);
+
+/* Demodulate one OFDM symbol of mode M against the previous one, both taken
+   straight from the FFT (not shifted), and write the frequency-deinterleaved
+   QPSK symbols (2 * K, 3072 in Mode I) to dst. Soft decisions are scaled to the
+   mean amplitude of the symbol, so weak carriers give less confident symbols.
+   Instantiated for dab_mode_1 to dab_mode_4. */
+template <const dab_mode_t& M>
+void dqpsk_demap(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
+/* The same for the MSC, writing the symbols packed (K bytes) */
+template <const dab_mode_t& M>
+void dqpsk_demap_packed(const fftwf_complex* cur, const fftwf_complex* prev, uint8_t* dst, bool soft);
@@ -0,0 +1,73 @@
+/* Signal energy over blocks of samples, used to find the null symbol.
+ *
+ * A block of 8 complex samples is 16 floats, i.e. 4 SSE / NEON registers.
+ * Four blocks are reduced at once, so the result of each step is again one
+ * full register.
+ */
+
+#include "energy.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ENERGY_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ENERGY_NEON
+#endif
+
+#define BLOCK_FLOATS (ENERGY_BLOCK * 2)
+
+#ifdef ENERGY_SSE2
+
+/* per-lane partial sums of one block */
+static inline __m128 block_sse2(const float* f) {
+    __m128 a = _mm_loadu_ps(f), b = _mm_loadu_ps(f + 4), c = _mm_loadu_ps(f + 8), d = _mm_loadu_ps(f + 12);
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)), _mm_add_ps(_mm_mul_ps(c, c), _mm_mul_ps(d, d)));
+}
+
+#endif
+
+#ifdef ENERGY_NEON
+
+static inline float32x4_t block_neon(const float* f) {
+    float32x4_t a = vld1q_f32(f), b = vld1q_f32(f + 4), c = vld1q_f32(f + 8), d = vld1q_f32(f + 12);
+    return vaddq_f32(vaddq_f32(vmulq_f32(a, a), vmulq_f32(b, b)), vaddq_f32(vmulq_f32(c, c), vmulq_f32(d, d)));
+}
+
+#endif
+
+void block_energy(const float* iq, float* energy, int nblocks) {
+    int b = 0;
+#ifdef ENERGY_SSE2
+    for (; b + 4 <= nblocks; b += 4, iq += 4 * BLOCK_FLOATS) {
+        __m128 s0 = block_sse2(iq), s1 = block_sse2(iq + BLOCK_FLOATS);
+        __m128 s2 = block_sse2(iq + 2 * BLOCK_FLOATS), s3 = block_sse2(iq + 3 * BLOCK_FLOATS);
+        /* after the transpose, every register holds one lane of all four blocks */
+        _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+        _mm_storeu_ps(energy + b, _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+    }
+#endif
+#ifdef ENERGY_NEON
+    for (; b + 4 <= nblocks; b += 4, iq += 4 * BLOCK_FLOATS) {
+        float32x4_t s0 = block_neon(iq), s1 = block_neon(iq + BLOCK_FLOATS);
+        float32x4_t s2 = block_neon(iq + 2 * BLOCK_FLOATS), s3 = block_neon(iq + 3 * BLOCK_FLOATS);
+        /* pairwise additions reduce each block to one lane, in block order */
+        float32x2_t p0 = vpadd_f32(vget_low_f32(s0), vget_high_f32(s0));
+        float32x2_t p1 = vpadd_f32(vget_low_f32(s1), vget_high_f32(s1));
+        float32x2_t p2 = vpadd_f32(vget_low_f32(s2), vget_high_f32(s2));
+        float32x2_t p3 = vpadd_f32(vget_low_f32(s3), vget_high_f32(s3));
+        vst1q_f32(energy + b, vcombine_f32(vpadd_f32(p0, p1), vpadd_f32(p2, p3)));
+    }
+#endif
+    for (; b < nblocks; b++, iq += BLOCK_FLOATS) {
+        float s = 0;
+        for (int k = 0; k < BLOCK_FLOATS; k++) s += iq[k] * iq[k];
+        energy[b] = s;
+    }
+}
+
+float window_energy(const float* iq, int n) {
+    float s = 0;
+    for (int k = 0; k < 2 * n; k++) s += iq[k] * iq[k];
+    return s;
+}
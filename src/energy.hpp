@@ -0,0 +1,11 @@
+#pragma once
+
+/* Number of samples per block of block_energy() */
+#define ENERGY_BLOCK 8
+
+/* Energy (sum of I^2 + Q^2) of each block of ENERGY_BLOCK consecutive
+   complex samples, given as interleaved I/Q floats */
+void block_energy(const float* iq, float* energy, int nblocks);
+
+/* Energy of n consecutive complex samples */
+float window_energy(const float* iq, int n);
@@ -40,10 +40,12 @@ void dump_tf_info(struct tf_info_t* info)
 
 /* Simple FIB/FIG parser to extract information from FIG 0/0
    (Ensemble Information - CIFCount) and FIG 0/1 (Sub-channel
-   information) needed to create ETI stream */
-void fib_parse(struct tf_info_t* info, uint8_t* fib)
+   information) needed to create ETI stream. Returns the CIF count from
+   FIG 0/0, -1 if the FIB does not carry one. */
+int fib_parse(struct tf_info_t* info, uint8_t* fib)
 {
     int i,j,k;
+    int cif_count = -1;
 
     i = 0;
     while ((fib[i] != 0xff) && (i < 30)) {
@@ -63,6 +65,8 @@ void fib_parse(struct tf_info_t* info, uint8_t* fib)
                 info->EId = (fib[i+1] << 8) | fib[i+2];
                 info->CIFCount_hi = fib[i+3] & 0x1f;
                 info->CIFCount_lo = fib[i+4];
+                if ((info->CIFCount_hi < 20) && (info->CIFCount_lo < 250))
+                    cif_count = info->CIFCount_hi * 250 + info->CIFCount_lo;
             } else if (ext == 1) { // FIG 0/1
                 j = i + 1;
                 while (j < i + len) {
@@ -182,9 +186,10 @@ void fib_parse(struct tf_info_t* info, uint8_t* fib)
         }
         i += len;
     }
+    return cif_count;
 }
 
-struct tf_info_t fib_decode(struct tf_fibs_t *fibs, int nfibs) {
+struct tf_info_t fib_decode(struct tf_fibs_t *fibs, int nfibs, int fibs_per_cif) {
     int i;
 
     /* Initialise the info struct */
@@ -192,13 +197,18 @@ struct tf_info_t fib_decode(struct tf_fibs_t *fibs, int nfibs) {
         .EId = 0,
         .CIFCount_hi = 0,
         .CIFCount_lo = 0,
+        .timestamp = 0,
     };
 
     /* Parse nfibs FIBs */
     for (i = 0; i < nfibs; i++) {
         if (fibs->FIB_CRC_OK[i]) {
             //fprintf(stderr,"fib_parse(%d)\n",i);
-            fib_parse(&info, fibs->FIB[i]);
+            int cif_count = fib_parse(&info, fibs->FIB[i]);
+            if (cif_count >= 0) {
+                /* FIB i belongs to CIF i / fibs_per_cif of the frame */
+                info.cif_count = (cif_count - i / fibs_per_cif + CIF_COUNT_MODULO) % CIF_COUNT_MODULO;
+            }
         }
     }
 
@@ -213,32 +223,34 @@ static uint8_t null_fib[32] = {
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa8, 0xa8
 };
 
-/* Convert the 3 demapped FIC symbols (3 * 3072 bits) into 4 sets of 3
-   32-byte FIBs, check the FIB CRCs, and parse ensemble and sub-channel information. */
+/* Convert the demapped FIC symbols (3 * 3072 bits in Mode I) into one set of
+   32-byte FIBs per CIF (4 sets of 3 in Mode I), and check the FIB CRCs. */
 
-void fic_decode(struct demapped_transmission_frame_t *tf)
+void fic_decode(struct viterbi_decoder *vd, const struct dab_mode_t *mode, struct demapped_transmission_frame_t *tf)
 {
-    uint8_t tmp[3096];
+    struct viterbi_puncturing punct;
     int i,j;
+    int bits = mode->fibs_per_cif * 256;  /* FIBs of one CIF, 768 bits in Mode I, II and IV, 1024 in Mode III */
+    int block = mode->fic_symbols * mode->symbol_bits() / mode->cifs;
+
+    fic_puncturing(&punct, mode->fibs_per_cif);
 
     tf->fibs.ok_count = 0;
+    tf->fibs.count = mode->cifs * mode->fibs_per_cif;
 
     int fib = 0;
 
-    /* The 3 FIC symbols are 3*3072 = 9216 bits in total.
-       We treat them as 4 sets of 2304 bits */
-    for (i=0;i<4;i++) {
-        /* depuncture, 2304->3096 */
-        fic_depuncture(tmp, tf->fic_symbols_demapped[0]+(i*2304));
-
-        /* viterbi, 3096 -> 768.  Output is converted to bytes (768/8 = 96) */
-        viterbi(tmp, tf->fibs.FIB[fib], 768);
+    /* The FIC symbols are one block of punctured bits per CIF: the 3*3072 = 9216 bits
+       of Mode I are 4 sets of 2304 bits, Mode III has one set of 3072 bits */
+    for (i=0;i<mode->cifs;i++) {
+        /* punctured viterbi, 2304 -> 768.  Output is converted to bytes (768/8 = 96) */
+        viterbi(vd, tf->fic_symbols_demapped[0]+(i*block), &punct, tf->fibs.FIB[fib]);
 
         /* descramble (in-place), 768->768 */
-        dab_descramble_bytes(tf->fibs.FIB[fib], 96);
+        dab_descramble_bytes(tf->fibs.FIB[fib], bits / 8);
 
-        /* Now check the CRCs of the three FIBs. */
-        for (j=0;j<3;j++) {
+        /* Now check the CRCs of the FIBs. */
+        for (j=0;j<mode->fibs_per_cif;j++) {
             tf->fibs.FIB_CRC_OK[fib] = check_fib_crc(tf->fibs.FIB[fib]);
 
             if (tf->fibs.FIB_CRC_OK[fib]) {
@@ -1,6 +1,7 @@
 #pragma once
 
 int crc16(unsigned char *buf, int len, int width);
-struct tf_info_t fib_decode(struct tf_fibs_t *fibs, int nfibs);
-void fic_decode(struct demapped_transmission_frame_t *tf);
+/* The information in the FIBs with a good CRC, nfibs of them in fibs_per_cif FIBs per CIF */
+struct tf_info_t fib_decode(struct tf_fibs_t *fibs, int nfibs, int fibs_per_cif);
+void fic_decode(struct viterbi_decoder *vd, const struct dab_mode_t *mode, struct demapped_transmission_frame_t *tf);
 void dump_tf_info(struct tf_info_t* info);
@@ -0,0 +1,65 @@
+#include "frame_queue.hpp"
+
+using namespace Csdr::Eti;
+
+FrameQueue::FrameQueue(size_t slots):
+    size(slots),
+    // not value-initialized, every slot is written before it is read
+    slots(new demapped_transmission_frame_t[slots])
+{}
+
+template <typename Predicate>
+void FrameQueue::wait(Predicate ready) {
+    std::unique_lock<std::mutex> lock(mutex);
+    waiters++;
+    changed.wait(lock, ready);
+    waiters--;
+}
+
+demapped_transmission_frame_t* FrameQueue::acquire() {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == size) {
+        wait([this, h] { return closed || h - tail.load() < size; });
+        if (closed) return nullptr;
+    }
+    return &slots[h % size];
+}
+
+void FrameQueue::push() {
+    // sequentially consistent, like the check for waiters in notify()
+    head.store(head.load(std::memory_order_relaxed) + 1);
+    notify();
+}
+
+demapped_transmission_frame_t* FrameQueue::front() {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t) {
+        wait([this, t] { return closed || head.load() != t; });
+        if (head.load(std::memory_order_acquire) == t) return nullptr;
+    }
+    return &slots[t % size];
+}
+
+void FrameQueue::pop() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1);
+    notify();
+}
+
+void FrameQueue::drain() {
+    wait([this] { return closed || tail.load() == head.load(); });
+}
+
+void FrameQueue::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    changed.notify_all();
+}
+
+void FrameQueue::notify() {
+    // a waiting thread counts itself before it checks its condition and the index was changed before this check, all
+    // sequentially consistent, so either it sees the new index or we see it. nobody waiting is the common case.
+    if (waiters.load() == 0) return;
+    // taking the lock makes sure a waiting thread has either not checked its condition yet or is already waiting
+    std::lock_guard<std::mutex> lock(mutex);
+    changed.notify_all();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "dab.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace Csdr::Eti {
+
+    // single producer, single consumer queue of preallocated demapped frames. the producer demodulates into the slot
+    // returned by acquire() and hands it over with push(), the consumer decodes front() and returns it with pop().
+    // the slots are handed over through atomic indices, the mutex is only used to sleep while there is nothing to do
+    // and to wake a thread that does.
+    class FrameQueue {
+        public:
+            explicit FrameQueue(size_t slots);
+            // free slot to demodulate into, waits for one if all are in use. nullptr once the queue is closed.
+            demapped_transmission_frame_t* acquire();
+            void push();
+            // oldest frame handed over, waits for one. nullptr once the queue is closed and all frames are taken.
+            demapped_transmission_frame_t* front();
+            void pop();
+            // wait until the consumer has returned all frames
+            void drain();
+            void close();
+        private:
+            size_t size;
+            std::unique_ptr<demapped_transmission_frame_t[]> slots;
+            std::atomic<size_t> head {0};
+            std::atomic<size_t> tail {0};
+            std::mutex mutex;
+            std::condition_variable changed;
+            // threads waiting for changed, so the other side only has to take the mutex when there are any
+            std::atomic<int> waiters {0};
+            bool closed = false;
+            template <typename Predicate> void wait(Predicate ready);
+            void notify();
+    };
+
+}
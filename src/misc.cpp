@@ -4,6 +4,8 @@
 #include "dab.hpp"
 #include "misc.hpp"
 #include "depuncture.hpp"
+#include "decode_pool.hpp"
+#include "deinterleave.hpp"
 extern "C" {
 #include "viterbi.h"
 }
@@ -17,21 +19,14 @@ void merge_info(struct ens_info_t* ei, struct tf_info_t *info)
         ei->services[it.first] = it.second;
     }
     ei->EId = info->EId;
-    if (ei->CIFCount_hi == 0xff) {
-        ei->CIFCount_hi = info->CIFCount_hi;
-        ei->CIFCount_lo = info->CIFCount_lo;
-    }
 }
 
-void time_deinterleave(uint8_t* dst, uint8_t* cifs[])
+/* Time-deinterleave the n bits from bit first on of the oldest of the 16 CIFs
+   into dst. Only the capacity units that are decoded need to be gathered. */
+void time_deinterleave(uint8_t* dst, uint8_t* cifs[], int first, int n)
 {
-    int i, cif;
-    const int map[] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
-
-    for (i=0; i < 3072*18; i++) {
-        cif = map[i & 15];
-        *dst++ = cifs[cif][i];
-    }
+    static const deinterleave_kernel kernel = deinterleave_select(nullptr);
+    kernel(dst, cifs, first, n);
 }
 
 /* precalculated energy dispersal scrambler PRBS (period: 511 bytes) */
@@ -169,7 +164,7 @@ int check_fib_crc(uint8_t* data) {
 }
 
 
-int init_eti(uint8_t* eti, struct ens_info_t *info, std::map<int, struct subchannel_info_t>& subchans) {
+int init_eti(uint8_t* eti, const struct dab_mode_t *mode, struct ens_info_t *info, const subchannel_set_t& selected) {
     int i = 0;
     int j;
 
@@ -190,19 +185,21 @@ int init_eti(uint8_t* eti, struct ens_info_t *info, std::map<int, struct subchan
     //   FC()
     eti[i++] = info->CIFCount_lo; // FCT
     int FICF = 1;  // FIC present in MST
-    int NST = subchans.size();
+    int NST = selected.count();
     int FL = 0;
-    for (auto& it: subchans) {
+    for (auto& it: info->subchans) {
+        if (!selected[it.first]) continue;
         FL += (it.second.bitrate * 3) / 4;
     }
-    FL += NST + 1 + 24; // STC + EOH + MST (FIC data, Mode 1!)
+    FL += NST + 1 + mode->fibs_per_cif * 8; // STC + EOH + MST (FIC data, 24 words, 32 in Mode III)
     eti[i++] = (FICF << 7) | NST;
     int FP = ((info->CIFCount_hi * 250) + info->CIFCount_lo) % 8; // TODO (Guess!)
-    int MID = 0x01; // We only support Mode 1
+    int MID = mode->id & 0x03; // Mode IV is 0
     eti[i++] = (FP << 5) | (MID << 3) | ((FL & 0x700) >> 8);
     eti[i++] = FL & 0xff;
     //   STC()
-    for (auto& it: subchans) {
+    for (auto& it: info->subchans) {
+        if (!selected[it.first]) continue;
         int SCID = it.first;
         int SAD = it.second.start_cu;
         int TPL;
@@ -230,118 +227,285 @@ int init_eti(uint8_t* eti, struct ens_info_t *info, std::map<int, struct subchan
     return i;
 }
 
-void create_eti(struct dab_state_t* dab) {
-    uint8_t *fibs = dab->cifs_fibs[0];
-    struct ens_info_t *info = &dab->ens_info;
-    uint8_t cif_time_deinterleaved[3072*18];
-    uint8_t dpbuf[3072*4*18];
-
-/* Constraint length */
-#define N 4
-/* Number of symbols per data bit */
-#define K 7
+/* Corrupted FIGs can describe subchannels that reach beyond the end of the CIF */
+static bool within_cif(const struct subchannel_info_t& sc) {
+    return sc.start_cu >= 0 && sc.size > 0 && sc.start_cu + sc.size <= 864;
+}
 
-    int len;
-    int bits;
-    int obytes;
-    int i;
-    uint8_t eti[6144];
+subchannel_set_t selected_subchannels(struct dab_state_t* dab) {
+    struct ens_info_t *info = &dab->ens_info;
 
     // if filtered, collect all the subchannels we are interested in
-    std::set<int> channel_filter;
+    subchannel_set_t channel_filter;
+    bool filtered = false;
     for (auto& it: dab->service_id_filter) {
-        if (dab->ens_info.services.count(it)) {
-            auto& subchans = dab->ens_info.services[it].subchannels;
-            channel_filter.insert(subchans.begin(), subchans.end());
+        auto service = info->services.find(it);
+        if (service == info->services.end()) continue;
+        for (int id: service->second.subchannels) {
+            filtered = true;
+            // service components of TMId 3 have ids of their own, which are no subchannel
+            if (id < MAX_SUBCHANNELS) channel_filter.set(id);
         }
     }
 
-    std::map<int, struct subchannel_info_t> subchans;
-    if (channel_filter.empty()) {
-        subchans = info->subchans;
-    } else {
-        for (auto it: info->subchans) {
-            if (channel_filter.count(it.first)) {
-                subchans[it.first] = it.second;
+    subchannel_set_t subchans;
+    for (auto& it: info->subchans) {
+        if ((!filtered || channel_filter[it.first]) && within_cif(it.second)) {
+            subchans.set(it.first);
+        }
+    }
+    return subchans;
+}
+
+msc_symbol_set_t needed_msc_symbols(struct dab_state_t* dab) {
+    const struct dab_mode_t *mode = dab->mode;
+    const int bits = mode->symbol_bits();
+    msc_symbol_set_t needed;
+
+    auto subchans = selected_subchannels(dab);
+    if (subchans.count() == dab->ens_info.subchans.size()) {
+        return needed.set();
+    }
+
+    /* The time interleaving keeps the bits at their position within the CIF, and the CIFs follow each other in the
+       MSC symbols, so a subchannel takes the same symbols of every CIF */
+    for (auto& it: dab->ens_info.subchans) {
+        if (!subchans[it.first]) continue;
+        for (int c = 0; c < mode->cifs; c++) {
+            int first = c * 3072 * 18 + it.second.start_cu * 64;
+            int last = first + it.second.size * 64 - 1;
+            for (int s = first / bits; s <= last / bits; s++) {
+                needed.set(s);
             }
         }
     }
+    return needed;
+}
+
+cif_cu_set_t demapped_cus(struct dab_state_t* dab, const msc_symbol_set_t& symbols, int cif) {
+    const int bits = dab->mode->symbol_bits();
+    cif_cu_set_t cus;
 
-    /* Create our ETI frame, including FIB data */
-    int e1 = init_eti(eti,info, subchans);
+    if (symbols.all()) {
+        return cus.set();
+    }
 
-    /* Add FIBs */
-    memcpy(eti+e1, fibs, 96);
-    int e = e1 + 96;
+    for (int cu = 0; cu < 864; cu++) {
+        int first = cif * 3072 * 18 + cu * 64;
+        int last = first + 63;
+        bool demapped = true;
+        for (int s = first / bits; s <= last / bits; s++) {
+            demapped = demapped && symbols[s];
+        }
+        cus[cu] = demapped;
+    }
+    return cus;
+}
 
-    /* Time-deinterleave the oldest CIF in the buffer */
-    time_deinterleave(cif_time_deinterleaved, dab->cifs_msc);
+/* Whether all selected subchannels were demapped in the 16 CIFs the oldest one is time-deinterleaved from. After the
+   service filter changed or new subchannels became known, the history is missing them until it has been refilled. */
+static bool history_complete(const cif_cu_set_t* cifs_demapped, const struct ens_info_t* info, const subchannel_set_t& subchans) {
+    cif_cu_set_t complete = cifs_demapped[0];
+    for (int k = 1; k < 16; k++) {
+        complete &= cifs_demapped[k];
+    }
+    if (complete.all()) {
+        return true;
+    }
+    for (auto& it: info->subchans) {
+        if (!subchans[it.first]) continue;
+        for (int cu = it.second.start_cu; cu < it.second.start_cu + it.second.size && cu < 864; cu++) {
+            if (!complete[cu]) return false;
+        }
+    }
+    return true;
+}
 
-    /* Now go through each subchannel, outputting the MSC data to our ETI frame */
-    for (auto it: subchans) {
-        struct subchannel_info_t sc = it.second;
+/* The received symbols a puncturing plan decodes */
+static int punctured_symbols(const struct viterbi_puncturing *p) {
+    int n = 0;
+    for (unsigned int s = 0; s < p->nsegments; s++) {
+        const auto *seg = &p->segment[s];
+        for (int k = 0; k < 8; k++) {
+            /* The steps using mask[k] */
+            int steps = seg->nsteps / 8 + (k < (int) (seg->nsteps % 8) ? 1 : 0);
+            n += steps * __builtin_popcount(seg->mask[k] & 0x0f);
+        }
+    }
+    return n;
+}
 
-        //  fprintf(stderr,"Decoding subchannel %d\n",sc->id);
-        /* Apply appropriate depuncture for each subchannel */
+static void increment_cif_count(struct ens_info_t *info) {
+    info->CIFCount_lo++;
+    if (info->CIFCount_lo == 250) {
+        info->CIFCount_lo = 0;
+        info->CIFCount_hi++;
+        if (info->CIFCount_hi == 20) {
+            info->CIFCount_hi = 0;
+        }
+    }
+}
+
+void skip_eti(struct dab_state_t* dab, int ncifs) {
+    for (int c = 0; c < ncifs; c++) {
+        increment_cif_count(&dab->ens_info);
+    }
+}
+
+void create_eti(struct dab_state_t* dab, unsigned char** cifs_msc, unsigned char** cifs_fibs, const cif_cu_set_t* cifs_demapped, int ncifs) {
+    struct ens_info_t *info = &dab->ens_info;
+
+    int bits;
+    int obytes;
+    int c;
+    uint8_t eti[MAX_CIFS_PER_FRAME][6144];
+    int e1[MAX_CIFS_PER_FRAME];
+    int e[MAX_CIFS_PER_FRAME];
+    bool complete[MAX_CIFS_PER_FRAME];
+    struct eti_task_t* tasks = dab->eti_tasks;
+    int ntasks = 0;
+
+    subchannel_set_t subchans = selected_subchannels(dab);
+
+    /* The subchannels take the same place in every ETI frame. Those that would not fit in after the ones before
+       them, which again only corrupted FIGs can lead to, are left out. */
+    struct viterbi_puncturing puncturing[MAX_SUBCHANNELS];
+    int subchan_bytes[MAX_SUBCHANNELS];
+    int room = 6144 - 12 - dab->mode->fibs_per_cif * 32 - 8;  /* Less the headers, the FIC and the end of frame */
+    int largest = 0;
+    for (auto& it: info->subchans) {
+        if (!subchans[it.first]) continue;
+        struct subchannel_info_t& sc = it.second;
+        struct viterbi_puncturing* punct = &puncturing[it.first];
+
+        /* Look up the puncturing of each subchannel */
         if (sc.eepprot)
-            eep_depuncture(dpbuf, cif_time_deinterleaved + sc.start_cu * 64, &sc, &len);
+            eep_puncturing(punct, &sc);
         else
-            uep_depuncture(dpbuf, cif_time_deinterleaved + sc.start_cu * 64, &sc, &len);
+            uep_puncturing(punct, &sc);
 
-        //fprintf(stderr,"Depunctured - len=%d, sc->size=%d\n",len,sc->size);
+        /* A puncturing that does not match the size would decode more than the capacity units of the subchannel */
+        if (punctured_symbols(punct) > sc.size * 64) {
+            subchans.reset(it.first);
+            continue;
+        }
 
-        bits = len/N - (K - 1);
+        bits = punct->nbits;
         obytes = ((bits / 8) + 7) & 0xfff8; /* Round up to multiple of 64 bits (8 bytes) */
 
-        viterbi(dpbuf, eti + e, bits);
+        /* Each subchannel also takes 4 bytes in the stream characterisation */
+        if (4 + obytes > room) {
+            subchans.reset(it.first);
+            continue;
+        }
+        room -= 4 + obytes;
+        subchan_bytes[it.first] = obytes;
+        if (sc.size > largest) largest = sc.size;
+    }
+
+    /* Each thread time-deinterleaves into a buffer of its own, which only grows when a larger subchannel turns up */
+    if (largest * 64 > dab->deinterleaved_stride) {
+        dab->deinterleaved_stride = largest * 64;
+    }
+    size_t deinterleaved_size = (dab->pool_viterbi.size() + 1) * dab->deinterleaved_stride;
+    if (dab->deinterleaved.size() < deinterleaved_size) {
+        dab->deinterleaved.resize(deinterleaved_size);
+    }
+
+    for (c=0; c < ncifs; c++) {
+        /* Skipped CIFs still count */
+        complete[c] = history_complete(cifs_demapped + c, info, subchans);
+        if (!complete[c]) {
+            increment_cif_count(info);
+            continue;
+        }
+
+        /* Create our ETI frame, including FIB data */
+        e1[c] = init_eti(eti[c], dab->mode, info, subchans);
+        increment_cif_count(info);
+
+        /* Add FIBs */
+        memcpy(eti[c]+e1[c], cifs_fibs[c], dab->mode->fibs_per_cif * 32);
+        e[c] = e1[c] + dab->mode->fibs_per_cif * 32;
+
+        /* Lay out the MSC data of each subchannel in our ETI frame */
+        for (auto& it: info->subchans) {
+            if (!subchans[it.first]) continue;
+            struct eti_task_t& task = tasks[ntasks++];
+
+            task.cifs = cifs_msc + c;
+            task.out = eti[c] + e[c];
+            task.obytes = subchan_bytes[it.first];
+            task.start_cu = it.second.start_cu;
+            task.size = it.second.size;
+            task.punct = puncturing[it.first];
+            e[c] += task.obytes;
+        }
+    }
+
+    /* The subchannels only depend on their part of the CIF, so they can be decoded in any order. The tasks hold all
+       the decoding needs, as a capture small enough for std::function to keep without allocating. */
+    auto decode = [dab] (int t, int thread) {
+        struct eti_task_t& task = dab->eti_tasks[t];
+        struct viterbi_decoder* vd = thread == 0 ? dab->viterbi : dab->pool_viterbi[thread - 1];
+        uint8_t* deinterleaved = dab->deinterleaved.data() + (size_t) thread * dab->deinterleaved_stride;
+        uint8_t* out = task.out;
+
+        /* Time-deinterleave the capacity units of the subchannel, CIF c being the oldest of cifs_msc[c] to cifs_msc[c + 15] */
+        time_deinterleave(deinterleaved, task.cifs, task.start_cu * 64, task.size * 64);
+
+        //  fprintf(stderr,"Decoding subchannel %d\n",sc->id);
+        viterbi(vd, deinterleaved, &task.punct, out);
 
-        dab_descramble_bytes(eti + e, obytes);
+        dab_descramble_bytes(out, task.obytes);
 
 #if 0
         /* TODO: Possibly check CRC.  This is not straightforward, as it
 	    is only calculated over part of the frame, and you need to
 	    parse the MPEG data to find out how many bits are included in
 	    the CRC check. */
-        int my_crc = calc_crc(eti+e+2,2,crctab_8005,0xffff);
-        my_crc = calc_crc(eti+e+6,obytes-6,crctab_8005,my_crc);
-        int mpeg_crc = (eti[e+4] << 8) | eti[e+5];
+        int my_crc = calc_crc(out+2,2,crctab_8005,0xffff);
+        my_crc = calc_crc(out+6,task.obytes-6,crctab_8005,my_crc);
+        int mpeg_crc = (out[4] << 8) | out[5];
         fprintf(stderr,"my crc=0x%04x, crc in data = 0x%04x\n",my_crc,mpeg_crc);
 #endif
-        e += obytes;
-    }
-
-    // EOF - CRC
-    int crc = calc_crc(eti+e1,e-e1,crctab_1021,0xffff);
-    crc =~ crc;
-    eti[e++] = (crc & 0xff00) >> 8;
-    eti[e++] = crc & 0xff;
-    // EOF - RFU
-    eti[e++] = 0xff;
-    eti[e++] = 0xff;
-
-    /* TIST - 0xFFFFFF means timestamp not used */
-    eti[e++] = 0xff;
-    eti[e++] = 0xff;
-    eti[e++] = 0xff;
-    eti[e++] = 0xff;
-
-    /* Padding */
-    memset(eti+e, 0x55, 6144-e);
-
-    //fprintf(stderr,"Writing %d bytes (*8=%d, bits=%d)\n",obytes,obytes*8,bits);
-
-    /* Call the user's callback to do process the ETI */
-    if (dab->eti_callback) {
-        dab->eti_callback(eti);
+    };
+    if (dab->pool != nullptr) {
+        decode_pool_run(dab->pool, ntasks, decode);
+    } else {
+        for (int t=0; t < ntasks; t++) {
+            decode(t, 0);
+        }
     }
 
-    /* Increment CIF count */
-    info->CIFCount_lo++;
-    if (info->CIFCount_lo == 250) {
-        info->CIFCount_lo = 0;
-        info->CIFCount_hi++;
-        if (info->CIFCount_hi == 20) {
-            info->CIFCount_hi = 0;
+    /* Finish the frames in order */
+    for (c=0; c < ncifs; c++) {
+        if (!complete[c]) continue;
+
+        uint8_t *f = eti[c];
+        int i = e[c];
+
+        // EOF - CRC
+        int crc = calc_crc(f+e1[c],i-e1[c],crctab_1021,0xffff);
+        crc =~ crc;
+        f[i++] = (crc & 0xff00) >> 8;
+        f[i++] = crc & 0xff;
+        // EOF - RFU
+        f[i++] = 0xff;
+        f[i++] = 0xff;
+
+        /* TIST - 0xFFFFFF means timestamp not used */
+        f[i++] = 0xff;
+        f[i++] = 0xff;
+        f[i++] = 0xff;
+        f[i++] = 0xff;
+
+        /* Padding */
+        memset(f+i, 0x55, 6144-i);
+
+        /* Call the user's callback to do process the ETI */
+        if (dab->eti_callback) {
+            dab->eti_callback(f);
         }
     }
 }
@@ -1,9 +1,32 @@
 #pragma once
 
 #include "dab.hpp"
+extern "C" {
+#include "viterbi.h"
+}
 
 void merge_info(struct ens_info_t* ei, struct tf_info_t *info);
-void create_eti(struct dab_state_t* dab);
+/* The subchannels create_eti() outputs: those of the filtered services, all if there is no filter or none of them are known yet */
+subchannel_set_t selected_subchannels(struct dab_state_t* dab);
+/* The MSC symbols carrying the selected subchannels */
+msc_symbol_set_t needed_msc_symbols(struct dab_state_t* dab);
+/* The capacity units of CIF cif of a frame that are complete when the given MSC symbols were demapped */
+cif_cu_set_t demapped_cus(struct dab_state_t* dab, const msc_symbol_set_t& symbols, int cif);
+/* One subchannel of one CIF, decoded into its place in the ETI frame */
+struct eti_task_t {
+    unsigned char** cifs;  /* The 16 CIFs the subchannel is time-deinterleaved from, the oldest first */
+    uint8_t* out;
+    int obytes;
+    int start_cu;
+    int size;
+    struct viterbi_puncturing punct;
+};
+
+/* Output the ETI frames of ncifs CIFs, CIF c being time-deinterleaved from cifs_msc[c] to cifs_msc[c + 15].
+   CIFs for which a selected subchannel was not demapped in all of these are skipped. */
+void create_eti(struct dab_state_t* dab, unsigned char** cifs_msc, unsigned char** cifs_fibs, const cif_cu_set_t* cifs_demapped, int ncifs);
+/* Account for ncifs CIFs that are not output, so the CIF count of the ETI frames keeps running */
+void skip_eti(struct dab_state_t* dab, int ncifs);
 void dump_ens_info(struct ens_info_t* info);
 void dab_descramble_bytes(uint8_t *buf, int32_t nbytes);
 int check_fib_crc(uint8_t* data);
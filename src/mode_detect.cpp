@@ -0,0 +1,115 @@
+/* Detection of the DAB transmission mode.
+ *
+ * Every OFDM symbol starts with a copy of its last Tg samples, so the input
+ * correlates with itself N samples later during the guard intervals. The
+ * products are folded modulo the symbol length of each mode, which adds up
+ * the guard intervals of all symbols in the span, and the best window of Tg
+ * samples is compared to the power in it. Only the mode the signal is in
+ * comes close to 1 there.
+ */
+
+#include "mode_detect.hpp"
+#include "energy.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+/* samples over which the guard interval correlation is folded, about 16 symbols of Mode I */
+#define MODE_DETECT_SPAN 40960
+/* minimum normalized guard interval correlation */
+#define MODE_DETECT_MIN_CORRELATION 0.2f
+/* the null symbol has less than this share of the mean energy */
+#define MODE_DETECT_NULL_DEPTH 0.5f
+/* tolerance in blocks of the null symbol period */
+#define MODE_DETECT_NULL_TOLERANCE 2
+
+static const struct dab_mode_t* const modes[] = { &dab_mode_1, &dab_mode_2, &dab_mode_3, &dab_mode_4 };
+
+/* normalized correlation of the guard intervals with the end of their symbols, at the best position */
+static float guard_correlation(const float* iq, const struct dab_mode_t* mode) {
+    const int N = mode->fft_size;
+    const int Tg = mode->guard_length;
+    const int Ts = mode->symbol_length();
+    // Mode I has the longest symbols
+    float re[dab_mode_1.symbol_length()] = {}, im[dab_mode_1.symbol_length()] = {}, power[dab_mode_1.symbol_length()] = {};
+
+    for (int t = 0, s = 0; t < MODE_DETECT_SPAN; t++) {
+        const float* x = iq + 2 * t;
+        const float* y = iq + 2 * (t + N);
+        re[s] += x[0] * y[0] + x[1] * y[1];
+        im[s] += x[1] * y[0] - x[0] * y[1];
+        power[s] += 0.5f * (x[0] * x[0] + x[1] * x[1] + y[0] * y[0] + y[1] * y[1]);
+        if (++s == Ts) s = 0;
+    }
+
+    // sliding window of Tg over the folded symbol, which wraps around
+    float sum_re = 0, sum_im = 0, sum_power = 0;
+    for (int s = 0; s < Tg; s++) {
+        sum_re += re[s];
+        sum_im += im[s];
+        sum_power += power[s];
+    }
+    float best = 0;
+    for (int s = 0; s < Ts; s++) {
+        if (sum_power > 0) {
+            best = std::max(best, sqrtf(sum_re * sum_re + sum_im * sum_im) / sum_power);
+        }
+        int out = s, in = (s + Tg) % Ts;
+        sum_re += re[in] - re[out];
+        sum_im += im[in] - im[out];
+        sum_power += power[in] - power[out];
+    }
+    return best;
+}
+
+/* whether the quietest stretch of the null symbol length repeats once per frame */
+static bool null_symbol_period(const float* energy, const struct dab_mode_t* mode) {
+    const int blocks = MODE_DETECT_SAMPLES / ENERGY_BLOCK;
+    const int null_blocks = mode->null_length / ENERGY_BLOCK;
+    const int frame_blocks = mode->frame_length() / ENERGY_BLOCK;
+    const int windows = blocks - null_blocks + 1;
+
+    double total = 0;
+    for (int b = 0; b < blocks; b++) total += energy[b];
+    const double threshold = MODE_DETECT_NULL_DEPTH * total / blocks * null_blocks;
+
+    // running sum over the windows, as in the coarse time sync
+    std::vector<double> window(windows);
+    double sum = 0;
+    for (int b = 0; b < null_blocks; b++) sum += energy[b];
+    window[0] = sum;
+    int quietest = 0;
+    for (int w = 1; w < windows; w++) {
+        sum += energy[w + null_blocks - 1] - energy[w - 1];
+        window[w] = sum;
+        if (sum < window[quietest]) quietest = w;
+    }
+    if (window[quietest] >= threshold) return false;
+
+    // all other null symbols within the input have to be where the frame length puts them
+    for (int w = quietest % frame_blocks; w < windows; w += frame_blocks) {
+        double quiet = window[w];
+        for (int d = -MODE_DETECT_NULL_TOLERANCE; d <= MODE_DETECT_NULL_TOLERANCE; d++) {
+            if (w + d >= 0 && w + d < windows) quiet = std::min(quiet, window[w + d]);
+        }
+        if (quiet >= threshold) return false;
+    }
+    return true;
+}
+
+const struct dab_mode_t* dab_detect_mode(const float* iq, float* energy) {
+    const struct dab_mode_t* best = nullptr;
+    float best_correlation = MODE_DETECT_MIN_CORRELATION;
+    for (auto mode: modes) {
+        float correlation = guard_correlation(iq, mode);
+        if (correlation > best_correlation) {
+            best_correlation = correlation;
+            best = mode;
+        }
+    }
+    if (best == nullptr) return nullptr;
+
+    block_energy(iq, energy, MODE_DETECT_SAMPLES / ENERGY_BLOCK);
+    return null_symbol_period(energy, best) ? best : nullptr;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "dab.hpp"
+
+/* Number of samples dab_detect_mode() needs, the length of a Mode I frame */
+#define MODE_DETECT_SAMPLES 196608
+
+/* Find the transmission mode of a DAB signal given as MODE_DETECT_SAMPLES
+   interleaved I/Q samples at 2.048 MS/s. The guard intervals of the OFDM
+   symbols repeat the end of the symbols, which gives the mode with the best
+   normalized correlation at its symbol length. The null symbols of that mode
+   then have to show up as dips in the energy one frame apart. energy is
+   scratch space for MODE_DETECT_SAMPLES / ENERGY_BLOCK values. Returns nullptr
+   if there is no DAB signal. */
+const struct dab_mode_t* dab_detect_mode(const float* iq, float* energy);
@@ -0,0 +1,97 @@
+#pragma once
+
+/* Tables of the OFDM front end that depend on the transmission mode, generated
+   at compile time from the definitions in ETSI EN 300 401: the phase
+   reference symbol (clause 14.3.2) and the frequency interleaving (clause 14.6).
+   Carriers are counted from the lowest one, k = -K/2, skipping the unused center
+   carrier, which is also the order dqpsk_demap() works in.
+ */
+
+#include "dab.hpp"
+
+#include <array>
+#include <cstdint>
+
+/* Time-frequency-phase parameter h of the phase reference symbol, table 44 */
+static constexpr uint8_t prs_h[4][32] = {
+    {0, 2, 0, 0, 0, 0, 1, 1, 2, 0, 0, 0, 2, 2, 1, 1, 0, 2, 0, 0, 0, 0, 1, 1, 2, 0, 0, 0, 2, 2, 1, 1},
+    {0, 3, 2, 3, 0, 1, 3, 0, 2, 1, 2, 3, 2, 3, 3, 0, 0, 3, 2, 3, 0, 1, 3, 0, 2, 1, 2, 3, 2, 3, 3, 0},
+    {0, 0, 0, 2, 0, 2, 1, 3, 2, 2, 0, 2, 2, 0, 1, 3, 0, 0, 0, 2, 0, 2, 1, 3, 2, 2, 0, 2, 2, 0, 1, 3},
+    {0, 1, 2, 1, 0, 3, 3, 2, 2, 3, 2, 1, 2, 1, 3, 2, 0, 1, 2, 1, 0, 3, 3, 2, 2, 3, 2, 1, 2, 1, 3, 2},
+};
+
+/* One block of 32 carriers of the phase reference symbol, starting at carrier k', tables 39 to 42 */
+struct prs_block_t {
+    int16_t k;
+    uint8_t i;
+    uint8_t n;
+};
+
+static constexpr prs_block_t prs_blocks_1[] = {
+    {-768, 0, 1}, {-736, 1, 2}, {-704, 2, 0}, {-672, 3, 1}, {-640, 0, 3}, {-608, 1, 2}, {-576, 2, 2}, {-544, 3, 3},
+    {-512, 0, 2}, {-480, 1, 1}, {-448, 2, 2}, {-416, 3, 3}, {-384, 0, 1}, {-352, 1, 2}, {-320, 2, 3}, {-288, 3, 3},
+    {-256, 0, 2}, {-224, 1, 2}, {-192, 2, 2}, {-160, 3, 1}, {-128, 0, 1}, {-96, 1, 3}, {-64, 2, 1}, {-32, 3, 2},
+    {1, 0, 3}, {33, 3, 1}, {65, 2, 1}, {97, 1, 1}, {129, 0, 2}, {161, 3, 2}, {193, 2, 1}, {225, 1, 0},
+    {257, 0, 2}, {289, 3, 2}, {321, 2, 3}, {353, 1, 3}, {385, 0, 0}, {417, 3, 2}, {449, 2, 1}, {481, 1, 3},
+    {513, 0, 3}, {545, 3, 3}, {577, 2, 3}, {609, 1, 0}, {641, 0, 3}, {673, 3, 0}, {705, 2, 1}, {737, 1, 1},
+};
+
+static constexpr prs_block_t prs_blocks_2[] = {
+    {-192, 0, 2}, {-160, 1, 3}, {-128, 2, 2}, {-96, 3, 2}, {-64, 0, 1}, {-32, 1, 2},
+    {1, 2, 0}, {33, 1, 2}, {65, 0, 2}, {97, 3, 1}, {129, 2, 0}, {161, 1, 3},
+};
+
+static constexpr prs_block_t prs_blocks_3[] = {
+    {-96, 0, 2}, {-64, 1, 3}, {-32, 2, 0}, {1, 3, 2}, {33, 2, 2}, {65, 1, 2},
+};
+
+static constexpr prs_block_t prs_blocks_4[] = {
+    {-384, 0, 0}, {-352, 1, 1}, {-320, 2, 1}, {-288, 3, 2}, {-256, 0, 2}, {-224, 1, 2}, {-192, 2, 0}, {-160, 3, 3},
+    {-128, 0, 3}, {-96, 1, 1}, {-64, 2, 3}, {-32, 3, 2}, {1, 0, 0}, {33, 3, 1}, {65, 2, 0}, {97, 1, 2},
+    {129, 0, 0}, {161, 3, 1}, {193, 2, 2}, {225, 1, 2}, {257, 0, 2}, {289, 3, 1}, {321, 2, 3}, {353, 1, 0},
+};
+
+template <const dab_mode_t& M>
+struct mode_tables {
+    static constexpr int K = M.carriers;
+    static constexpr int N = M.fft_size;
+
+    /* FFT bin of carrier k, the lower half of the carriers being the upper half of the bins */
+    static constexpr int bin(int k) {
+        return k < K / 2 ? k + N - K / 2 : k - K / 2 + 1;
+    }
+
+    /* The phase reference symbol as interleaved real and imaginary parts, all of them -1, 0 or 1 */
+    static constexpr std::array<float, 2 * K> make_prs() {
+        const prs_block_t* blocks = M.id == 1 ? prs_blocks_1 : M.id == 2 ? prs_blocks_2 : M.id == 3 ? prs_blocks_3 : prs_blocks_4;
+        std::array<float, 2 * K> prs {};
+        for (int b = 0; b < K / 32; b++) {
+            for (int j = 0; j < 32; j++) {
+                // the phase is a multiple of pi / 2
+                int phase = (prs_h[blocks[b].i][j] + blocks[b].n) % 4;
+                int k = b * 32 + j;
+                prs[2 * k] = phase == 0 ? 1 : phase == 2 ? -1 : 0;
+                prs[2 * k + 1] = phase == 1 ? 1 : phase == 3 ? -1 : 0;
+            }
+        }
+        return prs;
+    }
+
+    /* Position of the bits of carrier k in the deinterleaved symbol, the inverse of the interleaving rule */
+    static constexpr std::array<uint16_t, K> make_deinterleave() {
+        std::array<uint16_t, K> table {};
+        int pi = 0;
+        int n = 0;
+        for (int i = 0; i < N; i++) {
+            if (i > 0) pi = (13 * pi + N / 4 - 1) % N;
+            if (pi >= (N - K) / 2 && pi <= (N + K) / 2 && pi != N / 2) {
+                int k = pi - N / 2;
+                table[k < 0 ? K / 2 + k : K / 2 + k - 1] = n++;
+            }
+        }
+        return table;
+    }
+
+    static constexpr std::array<float, 2 * K> prs = make_prs();
+    static constexpr std::array<uint16_t, K> deinterleave = make_deinterleave();
+};
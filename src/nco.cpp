@@ -0,0 +1,92 @@
+/* Numerically controlled oscillator, used to take a frequency offset out of
+ * the input.
+ *
+ * Four consecutive samples are rotated at once, with one phasor per lane.
+ * All phasors advance by four times the increment after each step.
+ */
+
+#include "nco.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define NCO_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NCO_NEON
+#endif
+
+/* rotates up to NCO_CHUNK samples, starting with the phasors in re / im */
+static void rotate_chunk(const float* in, float* out, int n, float re[4], float im[4], float step_re, float step_im) {
+    int k = 0;
+#ifdef NCO_SSE2
+    __m128 pr = _mm_loadu_ps(re), pi = _mm_loadu_ps(im);
+    const __m128 sr = _mm_set1_ps(step_re), si = _mm_set1_ps(step_im);
+    for (; k + 4 <= n; k += 4) {
+        __m128 a = _mm_loadu_ps(in + 2 * k), b = _mm_loadu_ps(in + 2 * k + 4);
+        /* deinterleave into the real and imaginary parts of four samples */
+        __m128 xr = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 xi = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 yr = _mm_sub_ps(_mm_mul_ps(xr, pr), _mm_mul_ps(xi, pi));
+        __m128 yi = _mm_add_ps(_mm_mul_ps(xr, pi), _mm_mul_ps(xi, pr));
+        _mm_storeu_ps(out + 2 * k, _mm_unpacklo_ps(yr, yi));
+        _mm_storeu_ps(out + 2 * k + 4, _mm_unpackhi_ps(yr, yi));
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(pr, sr), _mm_mul_ps(pi, si));
+        pi = _mm_add_ps(_mm_mul_ps(pr, si), _mm_mul_ps(pi, sr));
+        pr = tr;
+    }
+    _mm_storeu_ps(re, pr);
+    _mm_storeu_ps(im, pi);
+#endif
+#ifdef NCO_NEON
+    float32x4_t pr = vld1q_f32(re), pi = vld1q_f32(im);
+    for (; k + 4 <= n; k += 4) {
+        float32x4x2_t x = vld2q_f32(in + 2 * k), y;
+        y.val[0] = vmlsq_f32(vmulq_f32(x.val[0], pr), x.val[1], pi);
+        y.val[1] = vmlaq_f32(vmulq_f32(x.val[0], pi), x.val[1], pr);
+        vst2q_f32(out + 2 * k, y);
+        float32x4_t tr = vmlsq_n_f32(vmulq_n_f32(pr, step_re), pi, step_im);
+        pi = vmlaq_n_f32(vmulq_n_f32(pr, step_im), pi, step_re);
+        pr = tr;
+    }
+    vst1q_f32(re, pr);
+    vst1q_f32(im, pi);
+#endif
+    for (; k + 4 <= n; k += 4) {
+        for (int l = 0; l < 4; l++) {
+            float xr = in[2 * (k + l)], xi = in[2 * (k + l) + 1];
+            out[2 * (k + l)] = xr * re[l] - xi * im[l];
+            out[2 * (k + l) + 1] = xr * im[l] + xi * re[l];
+            float tr = re[l] * step_re - im[l] * step_im;
+            im[l] = re[l] * step_im + im[l] * step_re;
+            re[l] = tr;
+        }
+    }
+    for (int l = 0; k < n; k++, l++) {
+        float xr = in[2 * k], xi = in[2 * k + 1];
+        out[2 * k] = xr * re[l] - xi * im[l];
+        out[2 * k + 1] = xr * im[l] + xi * re[l];
+    }
+}
+
+double nco_rotate(const float* in, float* out, int n, double phase, double increment) {
+    const float step_re = (float) cos(4 * increment), step_im = (float) sin(4 * increment);
+    double lane_re[4], lane_im[4];
+    for (int l = 0; l < 4; l++) {
+        lane_re[l] = cos(l * increment);
+        lane_im[l] = sin(l * increment);
+    }
+    float re[4], im[4];
+    for (int k = 0; k < n; k += NCO_CHUNK) {
+        double c = cos(phase), s = sin(phase);
+        for (int l = 0; l < 4; l++) {
+            re[l] = (float) (c * lane_re[l] - s * lane_im[l]);
+            im[l] = (float) (c * lane_im[l] + s * lane_re[l]);
+        }
+        int len = n - k < NCO_CHUNK ? n - k : NCO_CHUNK;
+        rotate_chunk(in + 2 * k, out + 2 * k, len, re, im, step_re, step_im);
+        phase = remainder(phase + len * increment, 2 * M_PI);
+    }
+    return phase;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+/* Number of samples after which nco_rotate() recomputes its phasors from the
+   exact phase, which keeps the single precision rounding errors from adding up */
+#define NCO_CHUNK 256
+
+/* Multiplies n complex samples, given as interleaved I/Q floats, with
+   exp(j * (phase + k * increment)) for k = 0 .. n-1. in and out may be the same.
+   Returns the phase of the sample following the last one, wrapped to [-pi, pi]. */
+double nco_rotate(const float* in, float* out, int n, double phase, double increment);
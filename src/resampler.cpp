@@ -0,0 +1,132 @@
+/* Polyphase resampling by interpolation / decimation.
+ *
+ * The prototype filter is a Kaiser windowed sinc at the interpolated rate.
+ * Output sample n uses phase (n * decimation) % interpolation of it, which
+ * is a short FIR on the input. The taps of every phase are stored reversed
+ * and duplicated, so the dot product runs over the interleaved I/Q floats
+ * directly, two complex samples per SSE / NEON register.
+ */
+
+#include "resampler.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RESAMPLER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RESAMPLER_NEON
+#endif
+
+using namespace Csdr::Eti;
+
+#define OUTPUT_RATE 2048000
+// half the bandwidth of the ensemble. images from beyond OUTPUT_RATE - PASSBAND only land outside of it.
+#define PASSBAND 768000
+#define ATTENUATION 70.0
+
+static double bessel_i0(double x) {
+    double sum = 1, term = 1;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+Resampler::Resampler(unsigned int rate) {
+    unsigned int g = std::gcd(rate, (unsigned int) OUTPUT_RATE);
+    interpolation = OUTPUT_RATE / g;
+    decimation = rate / g;
+    if (rate <= OUTPUT_RATE || interpolation > 1024) {
+        throw std::invalid_argument("cannot resample " + std::to_string(rate) + " S/s to 2048000 S/s");
+    }
+
+    // taps per phase for the transition band between PASSBAND and OUTPUT_RATE - PASSBAND, rounded to whole registers:
+    // 24 at 2400000 S/s, 88 at 10000000 S/s
+    double transition = (double) (OUTPUT_RATE - 2 * PASSBAND) / rate;
+    taps = (size_t) ceil((ATTENUATION - 8) / (2.285 * 2 * M_PI * transition));
+    taps = (taps + 3) & ~(size_t) 3;
+    offset = taps - 1;
+
+    size_t length = taps * interpolation;
+    double cutoff = (double) (OUTPUT_RATE / 2) / ((double) rate * interpolation);
+    double beta = 0.1102 * (ATTENUATION - 8.7);
+    double center = (length - 1) / 2.0;
+    std::vector<double> prototype(length);
+    for (size_t j = 0; j < length; j++) {
+        double t = j - center;
+        double sinc = t == 0 ? 1 : sin(2 * M_PI * cutoff * t) / (2 * M_PI * cutoff * t);
+        double r = t / center;
+        prototype[j] = 2 * cutoff * sinc * bessel_i0(beta * sqrt(std::max(0.0, 1 - r * r))) / bessel_i0(beta);
+    }
+    // every phase runs at the input rate, so the gain of each has to be 1
+    double gain = interpolation / std::accumulate(prototype.begin(), prototype.end(), 0.0);
+
+    filter.resize(interpolation * taps * 2);
+    for (unsigned int p = 0; p < interpolation; p++) {
+        float* f = &filter[p * taps * 2];
+        for (size_t k = 0; k < taps; k++) {
+            float h = (float) (prototype[p + k * interpolation] * gain);
+            // reversed, so tap k multiplies the input sample k positions before the newest one
+            f[2 * (taps - 1 - k)] = h;
+            f[2 * (taps - 1 - k) + 1] = h;
+        }
+    }
+}
+
+/* sum of x[k] * h[k] over n complex samples, as interleaved I/Q floats */
+static inline void dot(const float* x, const float* h, size_t n, float* result) {
+    size_t k = 0;
+    float re = 0, im = 0;
+#ifdef RESAMPLER_SSE2
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    for (; k + 4 <= n; k += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + 2 * k), _mm_loadu_ps(h + 2 * k)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + 2 * k + 4), _mm_loadu_ps(h + 2 * k + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    float sum[4];
+    _mm_storeu_ps(sum, acc);
+    re = sum[0];
+    im = sum[1];
+#endif
+#ifdef RESAMPLER_NEON
+    float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+    for (; k + 4 <= n; k += 4) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(x + 2 * k), vld1q_f32(h + 2 * k));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(x + 2 * k + 4), vld1q_f32(h + 2 * k + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    re = vget_lane_f32(sum, 0);
+    im = vget_lane_f32(sum, 1);
+#endif
+    for (; k < n; k++) {
+        re += x[2 * k] * h[2 * k];
+        im += x[2 * k + 1] * h[2 * k + 1];
+    }
+    result[0] = re;
+    result[1] = im;
+}
+
+size_t Resampler::process(const Csdr::complex<float>* in, size_t inLength, Csdr::complex<float>* out, size_t outLength, size_t& consumed) {
+    size_t produced = 0;
+    while (produced < outLength && offset < inLength) {
+        dot((const float*) (in + offset + 1 - taps), &filter[phase * taps * 2], taps, (float*) (out + produced));
+        produced++;
+        phase += decimation;
+        offset += phase / interpolation;
+        phase %= interpolation;
+    }
+    // keep what the next output sample still needs
+    consumed = std::min(offset + 1 - taps, inLength);
+    offset -= consumed;
+    return produced;
+}
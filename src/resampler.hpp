@@ -0,0 +1,33 @@
+#pragma once
+
+#include <csdr/complex.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace Csdr::Eti {
+
+    /* Rational polyphase resampler from common SDR sample rates down to the
+       2048000 S/s of DAB. Only the passband of the ensemble is kept clean,
+       everything that would alias into the carriers is suppressed by 70 dB. */
+    class Resampler {
+        public:
+            // throws std::invalid_argument if rate cannot be resampled to 2048000 S/s
+            explicit Resampler(unsigned int rate);
+            // samples of input that must be kept before the first output sample
+            size_t history() const { return taps - 1; }
+            /* produces at most outLength samples from inLength samples of input.
+               consumed receives the number of input samples that are not needed anymore,
+               everything after them has to be passed in again on the next call. */
+            size_t process(const Csdr::complex<float>* in, size_t inLength, Csdr::complex<float>* out, size_t outLength, size_t& consumed);
+        private:
+            unsigned int interpolation;
+            unsigned int decimation;
+            size_t taps;
+            // one set of taps per phase, in reverse order and each duplicated for I and Q
+            std::vector<float> filter;
+            // phase of the next output sample, and its position relative to the start of the input
+            unsigned int phase = 0;
+            size_t offset;
+    };
+
+}
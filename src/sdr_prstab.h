@@ -1,1544 +0,0 @@
-#include <fftw3.h>
-
-namespace Csdr::Eti {
-
-    fftwf_complex prs_static[1536] = {
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {1, 0},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {-1, 0},
-            {-1, 0},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {-1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {0, 1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {0, -1},
-            {0, -1},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1},
-            {0, 1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
-            {-1, 0},
-            {1, 0},
-            {0, 1},
-            {0, -1},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, -1},
-            {1, 0},
-            {1, 0},
-            {0, 1}
-    };
-
-}
\ No newline at end of file
@@ -45,13 +45,15 @@ unsigned int Poly615[] = { 042631, 047245, 073363, 056507, 077267, 064537 }; /*
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include "viterbi.h"
+#include "viterbi_dab.h"
 #define NULL ((void *)0)
 
 #undef max
 #define max(x,y) ((x) > (y) ? (x) : (y))
 
 /* 8-bit parity lookup table, generated by partab.c */
-unsigned char Partab[] = {
+const unsigned char Partab[] = {
         0, 1, 1, 0, 1, 0, 0, 1,
         1, 0, 0, 1, 0, 1, 1, 0,
         1, 0, 0, 1, 0, 1, 1, 0,
@@ -88,9 +90,6 @@ unsigned char Partab[] = {
 
 int Rate = N;
 
-int Syms[1 << K];
-int VDInit = 0;
-
 
 
 
@@ -335,107 +334,197 @@ int encode(
     return 0;
 }
 
-static int mettab[2][256];	/* Metric table, [sent sym][rx symbol] */
+/* Symbols sent for each encoder state (K bits), precomputed from Polys */
+static const int Syms[1 << K] = {
+         0, 15,  6,  9, 13,  2, 11,  4, 13,  2, 11,  4,  0, 15,  6,  9,
+         2, 13,  4, 11, 15,  0,  9,  6, 15,  0,  9,  6,  2, 13,  4, 11,
+         9,  6, 15,  0,  4, 11,  2, 13,  4, 11,  2, 13,  9,  6, 15,  0,
+        11,  4, 13,  2,  6,  9,  0, 15,  6,  9,  0, 15, 11,  4, 13,  2,
+        15,  0,  9,  6,  2, 13,  4, 11,  2, 13,  4, 11, 15,  0,  9,  6,
+        13,  2, 11,  4,  0, 15,  6,  9,  0, 15,  6,  9, 13,  2, 11,  4,
+         6,  9,  0, 15, 11,  4, 13,  2, 11,  4, 13,  2,  6,  9,  0, 15,
+         4, 11,  2, 13,  9,  6, 15,  0,  9,  6, 15,  0,  4, 11,  2, 13,
+};
 
-/* Viterbi decoder */
-int
-viterbi(
-        unsigned char *symbols,	/* Raw deinterleaved input symbols */
-        unsigned char *data,	/* Decoded output data */
-        unsigned int nbits	/* Number of output bits */
-){
-    unsigned int startstate = 0;         /* Encoder starting state */
-    unsigned int endstate = 0;            /* Encoder ending state */
-    int bitcnt = -(K-1);
-    long m0,m1;
-    int i,j,sym;
-    int mets[1 << N];
+/* Path memory is one 64-bit word of decisions per bit, so this decoder is
+   limited to K <= 7 */
+#define PATHWORDS(nbits) ((nbits) + K - 1)
 
-    const size_t LONGBITS = sizeof(long) * 8;
-    const unsigned int LOGLONGBITS = (unsigned int) log2f(LONGBITS);
-    const unsigned int D =1 << max(0, K - LOGLONGBITS - 1);
+struct viterbi_decoder {
+    int mettab[2][256];             /* Metric table, [sent sym][rx symbol], clamped to +-VITERBI_DAB_METRIC_LIMIT */
+    int16_t met[2][256];            /* 16-bit copy of mettab for the SIMD kernels */
+    viterbi_dab_kernel kernel;      /* NULL if no SIMD kernel is available */
+    uint64_t *paths;                /* Path memory, 64 byte aligned */
+    unsigned int maxbits;           /* Capacity of the path memory */
+};
 
-    // msvc does not like this ... beware if nbits <>768
-    unsigned long paths[(nbits+K-1)*D],*pp,mask;                    //!!!!!!!!!!!!!!!!!!!
-    //  unsigned long paths[(768+K-1)*D];
-    // unsigned long *pp,mask;
-    long cmetric[1 << (K-1)],nmetric[1 << (K-1)];
+static int alloc_paths(struct viterbi_decoder *vd, unsigned int maxbits)
+{
+    void *mem;
+    size_t size = PATHWORDS(maxbits) * sizeof(uint64_t);
+
+    /* round up to full cache lines */
+    size = (size + 63) & ~(size_t) 63;
+    if (posix_memalign(&mem, 64, size) != 0)
+        return -1;
+    free(vd->paths);
+    vd->paths = mem;
+    vd->maxbits = maxbits;
+    return 0;
+}
 
-    memset(paths,0,sizeof(paths));
+struct viterbi_decoder *create_viterbi(unsigned int maxbits, int amp)
+{
+    /* Noise the metrics are designed for, relative to amp. The decoder is not
+       very sensitive to this. Metrics beyond the range of the 16-bit SIMD
+       kernels (only for amp below 32) are clamped in the table itself, so the
+       generic decoder uses the same ones */
+    double noise = 0.7;
+    struct viterbi_decoder *vd = calloc(1, sizeof(struct viterbi_decoder));
+
+    if (vd == NULL)
+        return NULL;
+    if (alloc_paths(vd, maxbits) != 0) {
+        free(vd);
+        return NULL;
+    }
 
-    if(!VDInit){
-        for(i=0;i<(1<<K);i++){
-            sym = 0;
-            for(j=0;j<N;j++)
-                sym = (sym << 1) + parity(i & Polys[j]);
-            Syms[i] = sym;
-        }
-        VDInit++;
+    gen_met(vd->mettab,amp,noise,0.,8);
+    viterbi_dab_metrics(vd->met, vd->mettab);
+    vd->kernel = viterbi_dab_select(NULL);
+
+    return vd;
+}
+
+void delete_viterbi(struct viterbi_decoder *vd)
+{
+    if (vd == NULL)
+        return;
+    free(vd->paths);
+    free(vd);
+}
+
+void viterbi_add_segment(struct viterbi_puncturing *p, unsigned int nsteps, const char *pvec)
+{
+    struct viterbi_segment *seg;
+    unsigned int i,j,total = 0;
+
+    if(p->nsegments == VITERBI_MAX_SEGMENTS)
+        return;
+    seg = &p->segment[p->nsegments++];
+    seg->nsteps = nsteps;
+    for(i=0;i<8;i++){
+        seg->mask[i] = 0;
+        for(j=0;j<N;j++)
+            seg->mask[i] = (seg->mask[i] << 1) | (pvec[i*N+j] ? 1 : 0);
     }
 
+    for(i=0;i<p->nsegments;i++)
+        total += p->segment[i].nsteps;
+    p->nbits = total > K-1 ? total - (K-1) : 0;
+}
+
+/* Generic add-compare-select loop, used if there is no SIMD kernel */
+static void viterbi_generic(struct viterbi_decoder *vd, const unsigned char *symbols, const struct viterbi_puncturing *p)
+{
+    unsigned int startstate = 0;         /* Encoder starting state */
+    unsigned int seg,step,punct;
+    long m0,m1;
+    int i,j;
+    int mets[1 << N];
+    int symmet[N][2];
+    uint64_t *pp,dec,mask;
+    long cmetric[1 << (K-1)],nmetric[1 << (K-1)];
+
     startstate &= ~((1<<(K-1)) - 1);
-    endstate &= ~((1<<(K-1)) - 1);
 
     /* Initialize starting metrics */
     for(i=0;i< 1<<(K-1);i++)
         cmetric[i] = -999999;
     cmetric[startstate] = 0;
 
-    pp = paths;
-    for(;;){ /* For each data bit */
-        /* Read input symbols and compute branch metrics */
-        for(i=0;i< 1<<N;i++){
-            mets[i] = 0;
+    pp = vd->paths;
+    for(seg=0;seg<p->nsegments;seg++){
+        for(step=0;step<p->segment[seg].nsteps;step++){ /* For each data bit */
+            /* Read the transmitted input symbols, punctured ones have no metric */
+            punct = p->segment[seg].mask[step & 7];
             for(j=0;j<N;j++){
-                mets[i] += mettab[(i >> (N-j-1)) & 1][symbols[j]];
-            }
-        }
-        symbols += N;
-        /* Run the add-compare-select operations */
-        mask = 1;
-        for(i=0;i< 1 << (K-1);i+=2){
-            int b1,b2;
-
-            b1 = mets[Syms[i]];
-            nmetric[i] = m0 = cmetric[i/2] + b1;
-            b2 = mets[Syms[i+1]];
-            b1 -= b2;
-            m1 = cmetric[(i/2) + (1<<(K-2))] + b2;
-            if(m1 > m0){
-                nmetric[i] = m1;
-                *pp |= mask;
+                if(punct & (1 << (N-j-1))){
+                    symmet[j][0] = vd->mettab[0][*symbols];
+                    symmet[j][1] = vd->mettab[1][*symbols++];
+                } else {
+                    symmet[j][0] = symmet[j][1] = 0;
+                }
             }
-            m0 -= b1;
-            nmetric[i+1] = m0;
-            m1 += b1;
-            if(m1 > m0){
-                nmetric[i+1] = m1;
-                *pp |= mask << 1;
+            /* Compute branch metrics */
+            for(i=0;i< 1<<N;i++){
+                mets[i] = 0;
+                for(j=0;j<N;j++){
+                    mets[i] += symmet[j][(i >> (N-j-1)) & 1];
+                }
             }
-            mask <<= 2;
-            if(mask == 0){
-                mask = 1;
-                pp++;
+            /* Run the add-compare-select operations */
+            mask = 1;
+            dec = 0;
+            for(i=0;i< 1 << (K-1);i+=2){
+                int b1,b2;
+
+                b1 = mets[Syms[i]];
+                nmetric[i] = m0 = cmetric[i/2] + b1;
+                b2 = mets[Syms[i+1]];
+                b1 -= b2;
+                m1 = cmetric[(i/2) + (1<<(K-2))] + b2;
+                if(m1 > m0){
+                    nmetric[i] = m1;
+                    dec |= mask;
+                }
+                m0 -= b1;
+                nmetric[i+1] = m0;
+                m1 += b1;
+                if(m1 > m0){
+                    nmetric[i+1] = m1;
+                    dec |= mask << 1;
+                }
+                mask <<= 2;
             }
+            *pp++ = dec;
+            memcpy(cmetric,nmetric,sizeof(cmetric));
         }
-        if(mask != 1){
-            pp++;
-        }
-        if(++bitcnt == (int)nbits){
-            //*metric = nmetric[endstate];
-            break;
-        }
-        memcpy(cmetric,nmetric,sizeof(cmetric));
     }
+}
+
+/* Viterbi decoder */
+int
+viterbi(
+        struct viterbi_decoder *vd,
+        const unsigned char *symbols,	/* Transmitted deinterleaved input symbols */
+        const struct viterbi_puncturing *p,	/* Puncturing plan */
+        unsigned char *data	/* Decoded output data */
+){
+    unsigned int nbits = p->nbits;	/* Number of output bits */
+    unsigned int endstate = 0;            /* Encoder ending state */
+    uint64_t *pp;
+    int i;
+
+    /* Only happens if a caller did not size the decoder for its largest block */
+    if(nbits > vd->maxbits && alloc_paths(vd, nbits) != 0)
+        return -1;
+
+    if(vd->kernel)
+        vd->kernel(vd->met, symbols, p->segment, p->nsegments, vd->paths);
+    else
+        viterbi_generic(vd, symbols, p);
 
     /* Chain back from terminal state to produce decoded data */
     if(data == NULL)
         return 0;/* Discard output */
     memset(data,0,(nbits+7)/8); /* round up in case nbits % 8 != 0 */
 
+    endstate &= ~((1<<(K-1)) - 1);
+    pp = vd->paths + PATHWORDS(nbits);
     for(i=nbits-1;i >= 0;i--){
-        pp -= D;
-        if(pp[endstate >> LOGLONGBITS] & (1L << (endstate & (LONGBITS-1)))){
+        pp--;
+        if((*pp >> endstate) & 1){
             endstate |= (1 << (K-1));
             data[i>>3] |= 0x80 >> (i&7);
         }
@@ -443,13 +532,3 @@ viterbi(
     }
     return 0;
 }
-
-//-----
-int init_viterbi()
-{
-    int amp = 1;
-    double noise = 1.0;
-
-    gen_met(mettab,amp,noise,0.,4);
-    return 0;
-}
@@ -1,10 +1,41 @@
 #ifndef _VITERBI_H
 #define _VITERBI_H
 
-extern int mettab[2][256];
+/* Decoder context holding the metric tables and path memory. One instance
+   must not be used by more than one thread at a time. */
+struct viterbi_decoder;
 
-int init_viterbi();
+/* Maximum number of segments in a puncturing plan: up to four protection
+   levels (UEP) plus the tail */
+#define VITERBI_MAX_SEGMENTS 5
 
-void viterbi(unsigned char *symbols, unsigned char *data, int framebits);
+/* Puncturing plan of a received block. Each segment covers nsteps data bits
+   (trellis steps) of the mother code, step i of a segment transmitting the
+   symbols set in mask[i % 8] (bit 3 = first symbol). The plan covers the
+   nbits data bits plus the K-1 tail bits. */
+struct viterbi_puncturing {
+    unsigned int nbits;
+    unsigned int nsegments;
+    struct viterbi_segment {
+        unsigned int nsteps;
+        unsigned char mask[8];
+    } segment[VITERBI_MAX_SEGMENTS];
+};
+
+/* Create a decoder with path memory for blocks of up to maxbits output bits.
+   Input symbols are soft decisions, 128 being an erasure and 128 -/+ amp a
+   noiseless 0/1. */
+struct viterbi_decoder *create_viterbi(unsigned int maxbits, int amp);
+
+void delete_viterbi(struct viterbi_decoder *vd);
+
+/* Append a segment of nsteps trellis steps punctured by a 32 symbol
+   puncturing vector (1 = transmitted) */
+void viterbi_add_segment(struct viterbi_puncturing *p, unsigned int nsteps, const char *pvec);
+
+/* Decode a punctured block. The symbols are the transmitted ones only, in
+   the order they were received; punctured symbols don't contribute to any
+   metric. */
+int viterbi(struct viterbi_decoder *vd, const unsigned char *symbols, const struct viterbi_puncturing *p, unsigned char *data);
 
 #endif
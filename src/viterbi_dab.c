@@ -0,0 +1,314 @@
+/* Viterbi decoder specialised for the DAB mother code (K=7, rate 1/4, Poly47)
+ *
+ * Same trellis, tie breaking and chainback as the generic KA9Q decoder in
+ * viterbi.c, but with 16-bit saturating path metrics, SIMD add-compare-select
+ * butterflies over all 64 states and branch metrics computed from one table
+ * lookup per transmitted symbol. Path metrics are renormalised to state 0
+ * after every bit, which keeps the metric differences (and therefore all
+ * decisions) exact.
+ */
+
+#include <string.h>
+#include "viterbi_dab.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VITERBI_DAB_X86
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VITERBI_DAB_NEON
+#endif
+
+#define K 7                     /* Constraint length */
+#define N 4                     /* Number of symbols per data bit */
+#define STATES (1 << (K - 1))
+
+/* Starting metric of all states but the encoder starting state */
+#define INIT_METRIC (-16384)
+
+/* branch_mask[j][k] is all ones if code bit j of the branch from state k into
+ * state 2k is a 1 (parity of 2k and Poly47[j]). Since every polynomial has its
+ * lowest bit set, the branch from state k into 2k+1 (and from k+32 into 2k)
+ * carries the complement. */
+static const int16_t branch_mask[N][STATES / 2] __attribute__((aligned(32))) = {
+        { 0,  0, -1, -1, -1, -1,  0,  0,  0,  0, -1, -1, -1, -1,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1, -1, -1,  0,  0,  0,  0, -1, -1},
+        { 0, -1, -1,  0, -1,  0,  0, -1,  0, -1, -1,  0, -1,  0,  0, -1,  0, -1, -1,  0, -1,  0,  0, -1,  0, -1, -1,  0, -1,  0,  0, -1},
+        { 0, -1,  0, -1,  0, -1,  0, -1, -1,  0, -1,  0, -1,  0, -1,  0,  0, -1,  0, -1,  0, -1,  0, -1, -1,  0, -1,  0, -1,  0, -1,  0},
+        { 0,  0, -1, -1, -1, -1,  0,  0,  0,  0, -1, -1, -1, -1,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1, -1, -1,  0,  0,  0,  0, -1, -1},
+};
+
+/* Metrics of one received bit (N symbols, of which those not set in the
+ * puncturing mask were not transmitted): d[j] is the difference between a
+ * sent 1 and a sent 0 for symbol j, s0 and s1 are the totals for all zeroes
+ * and all ones. The branch metric of a butterfly is then s0 + sum(d & mask),
+ * and the one of its complement s1 - sum(d & mask). A punctured symbol adds
+ * nothing, like an erasure would. Returns the next symbol to read. */
+static inline const unsigned char *branch_metrics(const int16_t met[2][256], const unsigned char *symbols, unsigned int punct, int16_t d[N], int16_t *s0, int16_t *s1)
+{
+    int j;
+    int16_t m0, m1;
+
+    *s0 = 0;
+    *s1 = 0;
+    for (j = 0; j < N; j++) {
+        if (punct & (1 << (N - 1 - j))) {
+            m0 = met[0][*symbols];
+            m1 = met[1][*symbols++];
+            d[j] = m1 - m0;
+            *s0 += m0;
+            *s1 += m1;
+        } else {
+            d[j] = 0;
+        }
+    }
+    return symbols;
+}
+
+#ifdef VITERBI_DAB_X86
+
+__attribute__((target("sse2")))
+static void kernel_sse2(const int16_t met[2][256], const unsigned char *symbols, const struct viterbi_segment *segments, unsigned int nsegments, uint64_t *decisions)
+{
+    __m128i m[8], n[8], mask[N][4];
+    __m128i dv[N], s0v, s1v, acc, be, bo, m0e, m1e, m0o, m1o, de, dodd, ne, no, base;
+    int16_t d[N], s0, s1;
+    uint64_t dec;
+    unsigned int seg, i;
+    int r, j;
+
+    for (j = 0; j < N; j++)
+        for (r = 0; r < 4; r++)
+            mask[j][r] = _mm_loadu_si128((const __m128i*) &branch_mask[j][r * 8]);
+
+    m[0] = _mm_insert_epi16(_mm_set1_epi16(INIT_METRIC), 0, 0);
+    for (r = 1; r < 8; r++)
+        m[r] = _mm_set1_epi16(INIT_METRIC);
+
+    for (seg = 0; seg < nsegments; seg++) {
+        for (i = 0; i < segments[seg].nsteps; i++) {
+            symbols = branch_metrics(met, symbols, segments[seg].mask[i & 7], d, &s0, &s1);
+            for (j = 0; j < N; j++)
+                dv[j] = _mm_set1_epi16(d[j]);
+            s0v = _mm_set1_epi16(s0);
+            s1v = _mm_set1_epi16(s1);
+
+            dec = 0;
+            /* register r holds butterflies 8r..8r+7: old states 8r.. and 8r+32..,
+               new states 16r..16r+15 */
+            for (r = 0; r < 4; r++) {
+                acc = _mm_and_si128(dv[0], mask[0][r]);
+                for (j = 1; j < N; j++)
+                    acc = _mm_add_epi16(acc, _mm_and_si128(dv[j], mask[j][r]));
+                be = _mm_add_epi16(s0v, acc);
+                bo = _mm_sub_epi16(s1v, acc);
+
+                m0e = _mm_adds_epi16(m[r], be);
+                m1e = _mm_adds_epi16(m[r + 4], bo);
+                m0o = _mm_adds_epi16(m[r], bo);
+                m1o = _mm_adds_epi16(m[r + 4], be);
+
+                de = _mm_cmpgt_epi16(m1e, m0e);
+                dodd = _mm_cmpgt_epi16(m1o, m0o);
+                ne = _mm_max_epi16(m0e, m1e);
+                no = _mm_max_epi16(m0o, m1o);
+
+                n[2 * r] = _mm_unpacklo_epi16(ne, no);
+                n[2 * r + 1] = _mm_unpackhi_epi16(ne, no);
+                dec |= (uint64_t) (uint32_t) _mm_movemask_epi8(_mm_packs_epi16(
+                    _mm_unpacklo_epi16(de, dodd), _mm_unpackhi_epi16(de, dodd))) << (16 * r);
+            }
+            *decisions++ = dec;
+
+            base = _mm_shuffle_epi32(_mm_shufflelo_epi16(n[0], 0), 0);
+            for (r = 0; r < 8; r++)
+                m[r] = _mm_subs_epi16(n[r], base);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void kernel_avx2(const int16_t met[2][256], const unsigned char *symbols, const struct viterbi_segment *segments, unsigned int nsegments, uint64_t *decisions)
+{
+    __m256i m[4], n[4], mask[N][2];
+    __m256i dv[N], s0v, s1v, acc, be, bo, m0e, m1e, m0o, m1o, de, dodd, ne, no, lo, hi, base;
+    int16_t d[N], s0, s1;
+    uint64_t dec;
+    unsigned int seg, i;
+    int r, j;
+
+    for (j = 0; j < N; j++)
+        for (r = 0; r < 2; r++)
+            mask[j][r] = _mm256_loadu_si256((const __m256i*) &branch_mask[j][r * 16]);
+
+    m[0] = _mm256_insert_epi16(_mm256_set1_epi16(INIT_METRIC), 0, 0);
+    for (r = 1; r < 4; r++)
+        m[r] = _mm256_set1_epi16(INIT_METRIC);
+
+    for (seg = 0; seg < nsegments; seg++) {
+        for (i = 0; i < segments[seg].nsteps; i++) {
+            symbols = branch_metrics(met, symbols, segments[seg].mask[i & 7], d, &s0, &s1);
+            for (j = 0; j < N; j++)
+                dv[j] = _mm256_set1_epi16(d[j]);
+            s0v = _mm256_set1_epi16(s0);
+            s1v = _mm256_set1_epi16(s1);
+
+            dec = 0;
+            /* register r holds butterflies 16r..16r+15: old states 16r.. and
+               16r+32.., new states 32r..32r+31 */
+            for (r = 0; r < 2; r++) {
+                acc = _mm256_and_si256(dv[0], mask[0][r]);
+                for (j = 1; j < N; j++)
+                    acc = _mm256_add_epi16(acc, _mm256_and_si256(dv[j], mask[j][r]));
+                be = _mm256_add_epi16(s0v, acc);
+                bo = _mm256_sub_epi16(s1v, acc);
+
+                m0e = _mm256_adds_epi16(m[r], be);
+                m1e = _mm256_adds_epi16(m[r + 2], bo);
+                m0o = _mm256_adds_epi16(m[r], bo);
+                m1o = _mm256_adds_epi16(m[r + 2], be);
+
+                de = _mm256_cmpgt_epi16(m1e, m0e);
+                dodd = _mm256_cmpgt_epi16(m1o, m0o);
+                ne = _mm256_max_epi16(m0e, m1e);
+                no = _mm256_max_epi16(m0o, m1o);
+
+                /* unpack works within 128-bit lanes, so the halves need to be swapped back in order */
+                lo = _mm256_unpacklo_epi16(ne, no);
+                hi = _mm256_unpackhi_epi16(ne, no);
+                n[2 * r] = _mm256_permute2x128_si256(lo, hi, 0x20);
+                n[2 * r + 1] = _mm256_permute2x128_si256(lo, hi, 0x31);
+                /* ... while packing the decisions puts them back in state order already */
+                dec |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_packs_epi16(
+                    _mm256_unpacklo_epi16(de, dodd), _mm256_unpackhi_epi16(de, dodd))) << (32 * r);
+            }
+            *decisions++ = dec;
+
+            base = _mm256_broadcastw_epi16(_mm256_castsi256_si128(n[0]));
+            for (r = 0; r < 4; r++)
+                m[r] = _mm256_subs_epi16(n[r], base);
+        }
+    }
+}
+
+#endif
+
+#ifdef VITERBI_DAB_NEON
+
+static inline uint32_t neon_movemask(uint8x16_t x)
+{
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t b = vandq_u8(x, vld1q_u8(weights));
+#if defined(__aarch64__)
+    return vaddv_u8(vget_low_u8(b)) | ((uint32_t) vaddv_u8(vget_high_u8(b)) << 8);
+#else
+    uint8x8_t p = vpadd_u8(vget_low_u8(b), vget_high_u8(b));
+    p = vpadd_u8(p, p);
+    p = vpadd_u8(p, p);
+    return vget_lane_u8(p, 0) | ((uint32_t) vget_lane_u8(p, 1) << 8);
+#endif
+}
+
+static void kernel_neon(const int16_t met[2][256], const unsigned char *symbols, const struct viterbi_segment *segments, unsigned int nsegments, uint64_t *decisions)
+{
+    int16x8_t m[8], n[8], mask[N][4];
+    int16x8_t dv[N], s0v, s1v, acc, be, bo, m0e, m1e, m0o, m1o, ne, no, base;
+    uint16x8_t de, dodd;
+    int16x8x2_t z;
+    uint16x8x2_t zd;
+    int16_t d[N], s0, s1;
+    uint64_t dec;
+    unsigned int seg, i;
+    int r, j;
+
+    for (j = 0; j < N; j++)
+        for (r = 0; r < 4; r++)
+            mask[j][r] = vld1q_s16(&branch_mask[j][r * 8]);
+
+    m[0] = vsetq_lane_s16(0, vdupq_n_s16(INIT_METRIC), 0);
+    for (r = 1; r < 8; r++)
+        m[r] = vdupq_n_s16(INIT_METRIC);
+
+    for (seg = 0; seg < nsegments; seg++) {
+        for (i = 0; i < segments[seg].nsteps; i++) {
+            symbols = branch_metrics(met, symbols, segments[seg].mask[i & 7], d, &s0, &s1);
+            for (j = 0; j < N; j++)
+                dv[j] = vdupq_n_s16(d[j]);
+            s0v = vdupq_n_s16(s0);
+            s1v = vdupq_n_s16(s1);
+
+            dec = 0;
+            for (r = 0; r < 4; r++) {
+                acc = vandq_s16(dv[0], mask[0][r]);
+                for (j = 1; j < N; j++)
+                    acc = vaddq_s16(acc, vandq_s16(dv[j], mask[j][r]));
+                be = vaddq_s16(s0v, acc);
+                bo = vsubq_s16(s1v, acc);
+
+                m0e = vqaddq_s16(m[r], be);
+                m1e = vqaddq_s16(m[r + 4], bo);
+                m0o = vqaddq_s16(m[r], bo);
+                m1o = vqaddq_s16(m[r + 4], be);
+
+                de = vcgtq_s16(m1e, m0e);
+                dodd = vcgtq_s16(m1o, m0o);
+                ne = vmaxq_s16(m0e, m1e);
+                no = vmaxq_s16(m0o, m1o);
+
+                z = vzipq_s16(ne, no);
+                n[2 * r] = z.val[0];
+                n[2 * r + 1] = z.val[1];
+                zd = vzipq_u16(de, dodd);
+                dec |= (uint64_t) neon_movemask(vcombine_u8(vmovn_u16(zd.val[0]), vmovn_u16(zd.val[1]))) << (16 * r);
+            }
+            *decisions++ = dec;
+
+            base = vdupq_n_s16(vgetq_lane_s16(n[0], 0));
+            for (r = 0; r < 8; r++)
+                m[r] = vqsubq_s16(n[r], base);
+        }
+    }
+}
+
+#endif
+
+viterbi_dab_kernel viterbi_dab_select(const char **name)
+{
+    viterbi_dab_kernel kernel = NULL;
+    const char *kernel_name = "generic";
+
+#ifdef VITERBI_DAB_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernel = kernel_avx2;
+        kernel_name = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        kernel = kernel_sse2;
+        kernel_name = "sse2";
+    }
+#endif
+#ifdef VITERBI_DAB_NEON
+    kernel = kernel_neon;
+    kernel_name = "neon";
+#endif
+
+    if (name != NULL)
+        *name = kernel_name;
+    return kernel;
+}
+
+void viterbi_dab_metrics(int16_t met[2][256], int mettab[2][256])
+{
+    int bit, s, v;
+
+    for (bit = 0; bit < 2; bit++) {
+        for (s = 0; s < 256; s++) {
+            v = mettab[bit][s];
+            if (v > VITERBI_DAB_METRIC_LIMIT) v = VITERBI_DAB_METRIC_LIMIT;
+            if (v < -VITERBI_DAB_METRIC_LIMIT) v = -VITERBI_DAB_METRIC_LIMIT;
+            mettab[bit][s] = v;
+            met[bit][s] = (int16_t) v;
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef _VITERBI_DAB_H
+#define _VITERBI_DAB_H
+
+#include <stdint.h>
+#include "viterbi.h"
+
+/* SIMD add-compare-select kernels for the DAB mother code (K=7, rate 1/4,
+ * Poly47). The decisions are bit-exact with the generic decoder in viterbi.c,
+ * which works on the same metric table, clamped to +-VITERBI_DAB_METRIC_LIMIT
+ * by viterbi_dab_metrics().
+ */
+
+#define VITERBI_DAB_METRIC_LIMIT 255
+
+/* Runs the trellis steps of all segments, reading only the transmitted
+   symbols, and writes one 64-bit word of decisions per step */
+typedef void (*viterbi_dab_kernel)(const int16_t met[2][256], const unsigned char *symbols, const struct viterbi_segment *segments, unsigned int nsegments, uint64_t *decisions);
+
+/* Fastest kernel available on this CPU, or NULL if there is none.
+   If name is not NULL, it receives a description of the kernel. */
+viterbi_dab_kernel viterbi_dab_select(const char **name);
+
+/* Clamp a metric table in place, so all decoders use the same metrics, and
+   convert it into the 16-bit format used by the kernels */
+void viterbi_dab_metrics(int16_t met[2][256], int mettab[2][256]);
+
+#endif